@@ -1,5 +1,6 @@
 
 #include <SDL2/SDL_mutex.h>
+#include <SDL2/SDL_atomic.h>
 #include "htw_core.h"
 #include "basaltic_commandBuffer.h"
 
@@ -14,8 +15,32 @@ typedef struct private_bc_CommandBuffer {
     void *arenaHead; // pointer to next available address in arena
 
     SDL_mutex *lock;
+
+    // Ring mode only. Positions increase forever and wrap around u32; position & ringMask is the offset into arena
+    bool isRing;
+    u32 ringMask;
+    SDL_atomic_t writePosition; // end of the last complete record, set by producer
+    u32 producerHead; // producer's copy of writePosition
+    u8 padding[64]; // keep consumer fields off the producer's cache line
+    SDL_atomic_t readPosition; // start of the oldest unreleased record, set by consumer
+    u32 consumerCursor; // next record to read
+    u32 consumerEnd; // writePosition when processing began
 } private_bc_CommandBuffer;
 
+// Every ring record starts with a header, and is padded so that the next header is aligned
+typedef struct {
+    u32 size; // command data size, or RING_WRAP_MARKER
+    u32 reserved;
+} RingRecordHeader;
+
+// Record that fills the rest of the ring before it wraps, so command data is always contiguous
+#define RING_WRAP_MARKER 0xffffffff
+#define RING_RECORD_ALIGNMENT sizeof(RingRecordHeader)
+
+static u32 ringRecordSize(size_t dataSize);
+static bool pushCommandToRing(bc_CommandBuffer commandBuffer, const void* commandData, const size_t size);
+static void *getNextRingCommand(bc_CommandBuffer commandBuffer);
+
 bc_CommandBuffer bc_createCommandBuffer(u32 maxCommandsInBuffer, size_t arenaSize) {
     private_bc_CommandBuffer *newBuffer = malloc(sizeof(private_bc_CommandBuffer));
     newBuffer->commandArenaOffsets = calloc(maxCommandsInBuffer, sizeof(ptrdiff_t));
@@ -31,6 +56,25 @@ bc_CommandBuffer bc_createCommandBuffer(u32 maxCommandsInBuffer, size_t arenaSiz
     return newBuffer;
 }
 
+bc_CommandBuffer bc_createCommandRing(size_t ringSize) {
+    size_t capacity = RING_RECORD_ALIGNMENT * 2;
+    while (capacity < ringSize) {
+        capacity <<= 1;
+    }
+    private_bc_CommandBuffer *newBuffer = calloc(1, sizeof(private_bc_CommandBuffer));
+    newBuffer->isRing = true;
+    newBuffer->ringMask = capacity - 1;
+    newBuffer->arenaSize = capacity;
+    newBuffer->arena = calloc(1, capacity);
+    newBuffer->arenaHead = newBuffer->arena;
+    SDL_AtomicSet(&newBuffer->writePosition, 0);
+    SDL_AtomicSet(&newBuffer->readPosition, 0);
+
+    // Never used for synchronization, only so that destroy works the same way in both modes
+    newBuffer->lock = SDL_CreateMutex();
+    return newBuffer;
+}
+
 void bc_destroyCommandBuffer(bc_CommandBuffer commandBuffer) {
     SDL_mutex *holdLock = commandBuffer->lock;
     SDL_LockMutex(holdLock);
@@ -42,11 +86,17 @@ void bc_destroyCommandBuffer(bc_CommandBuffer commandBuffer) {
 }
 
 bool bc_commandBufferIsEmpty(bc_CommandBuffer commandBuffer) {
+    if (commandBuffer->isRing) {
+        return SDL_AtomicGet(&commandBuffer->writePosition) == SDL_AtomicGet(&commandBuffer->readPosition);
+    }
     return commandBuffer->currentCommandsInBuffer == 0;
 }
 
 // NOTE: would be *very* useful to have something like Go's "defer" here for locks, to avoid mistakes causing hard to trace errors; what is the best way to handle this in c?
 bool bc_pushCommandToBuffer(bc_CommandBuffer commandBuffer, const void* commandData, const size_t size) {
+    if (commandBuffer->isRing) {
+        return pushCommandToRing(commandBuffer, commandData, size);
+    }
     SDL_LockMutex(commandBuffer->lock);
     if (commandBuffer->currentCommandsInBuffer == commandBuffer->maxCommandsInBuffer) {
         // command buffer is full
@@ -69,6 +119,9 @@ bool bc_pushCommandToBuffer(bc_CommandBuffer commandBuffer, const void* commandD
 }
 
 bool bc_transferCommandBuffer(bc_CommandBuffer dst, bc_CommandBuffer src) {
+    if (dst->isRing || src->isRing) {
+        return false;
+    }
     SDL_LockMutex(src->lock);
     SDL_LockMutex(dst->lock);
     if (dst->currentCommandsInBuffer != 0 ||
@@ -96,13 +149,29 @@ bool bc_transferCommandBuffer(bc_CommandBuffer dst, bc_CommandBuffer src) {
 }
 
 u32 bc_beginBufferProcessing(bc_CommandBuffer commandBuffer) {
+    if (commandBuffer->isRing) {
+        commandBuffer->consumerCursor = SDL_AtomicGet(&commandBuffer->readPosition);
+        commandBuffer->consumerEnd = SDL_AtomicGet(&commandBuffer->writePosition);
+        // Pairs with release in pushCommandToRing, makes record contents visible
+        SDL_MemoryBarrierAcquire();
+        // Count by walking headers; cheap compared to processing the commands
+        u32 count = 0;
+        while (getNextRingCommand(commandBuffer) != NULL) {
+            count++;
+        }
+        commandBuffer->consumerCursor = SDL_AtomicGet(&commandBuffer->readPosition);
+        return count;
+    }
     SDL_LockMutex(commandBuffer->lock);
     commandBuffer->bufferReadHead = 0;
     return commandBuffer->currentCommandsInBuffer;
 }
 
 void *bc_getNextCommand(bc_CommandBuffer commandBuffer){
-    if (commandBuffer->bufferReadHead >= commandBuffer->maxCommandsInBuffer) {
+    if (commandBuffer->isRing) {
+        return getNextRingCommand(commandBuffer);
+    }
+    if (commandBuffer->bufferReadHead >= commandBuffer->currentCommandsInBuffer) {
         return NULL;
     }
     ptrdiff_t arenaOffset = commandBuffer->commandArenaOffsets[commandBuffer->bufferReadHead++];
@@ -110,8 +179,70 @@ void *bc_getNextCommand(bc_CommandBuffer commandBuffer){
 }
 
 void bc_endBufferProcessing(bc_CommandBuffer commandBuffer) {
+    if (commandBuffer->isRing) {
+        // Finish reading records before the producer can overwrite them
+        SDL_MemoryBarrierRelease();
+        SDL_AtomicSet(&commandBuffer->readPosition, commandBuffer->consumerEnd);
+        return;
+    }
     commandBuffer->currentCommandsInBuffer = 0;
     commandBuffer->arenaHead = commandBuffer->arena;
     commandBuffer->bufferReadHead = 0;
     SDL_UnlockMutex(commandBuffer->lock);
 }
+
+static u32 ringRecordSize(size_t dataSize) {
+    return (sizeof(RingRecordHeader) + dataSize + RING_RECORD_ALIGNMENT - 1) & ~(RING_RECORD_ALIGNMENT - 1);
+}
+
+static bool pushCommandToRing(bc_CommandBuffer commandBuffer, const void* commandData, const size_t size) {
+    u32 capacity = commandBuffer->ringMask + 1;
+    if (size >= capacity) {
+        return false;
+    }
+    u32 recordSize = ringRecordSize(size);
+    u32 head = commandBuffer->producerHead;
+    u32 offset = head & commandBuffer->ringMask;
+    u32 untilEnd = capacity - offset;
+    // If the record doesn't fit before the end of the arena, skip the remainder and start over at offset 0
+    u32 needed = recordSize <= untilEnd ? recordSize : untilEnd + recordSize;
+
+    u32 tail = SDL_AtomicGet(&commandBuffer->readPosition);
+    // Pairs with release in bc_endBufferProcessing; the consumer is done with the space before it's reused
+    SDL_MemoryBarrierAcquire();
+    if ((head - tail) + needed > capacity) {
+        // ring is full
+        return false;
+    }
+
+    if (needed != recordSize) {
+        RingRecordHeader *wrap = commandBuffer->arena + offset;
+        wrap->size = RING_WRAP_MARKER;
+        head += untilEnd;
+        offset = 0;
+    }
+    RingRecordHeader *header = commandBuffer->arena + offset;
+    header->size = size;
+    memcpy(header + 1, commandData, size);
+    head += recordSize;
+
+    commandBuffer->producerHead = head;
+    // Record must be completely written before the consumer can see the new position
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&commandBuffer->writePosition, head);
+    return true;
+}
+
+static void *getNextRingCommand(bc_CommandBuffer commandBuffer) {
+    while (commandBuffer->consumerCursor != commandBuffer->consumerEnd) {
+        u32 offset = commandBuffer->consumerCursor & commandBuffer->ringMask;
+        RingRecordHeader *header = commandBuffer->arena + offset;
+        if (header->size == RING_WRAP_MARKER) {
+            commandBuffer->consumerCursor += (commandBuffer->ringMask + 1) - offset;
+            continue;
+        }
+        commandBuffer->consumerCursor += ringRecordSize(header->size);
+        return header + 1;
+    }
+    return NULL;
+}
@@ -17,6 +17,9 @@
 #define GL_VERSION "#version 330"
 #endif
 
+static void plotModelTimes(bc_EditorEngineContext *eec, const char *label, const u64 *times, size_t stride, const bc_ModelTimingHistory *timings, u32 entryCount, u32 newest);
+static void drawModelSystemTable(const bc_ModelTimingHistory *timings);
+
 bc_EditorEngineContext bc_initEditor(bool isActiveAtStart, bc_WindowContext *wc) {
     // TODO: imgui saves imgui.ini in the cwd by default, which will usually be the data folder for this project. Consider changing it to a more useful default by setting io.IniFileName
     printf("Initializing cimgui SDL+OpenGL with glsl %s\n", GL_VERSION);
@@ -30,7 +33,7 @@ bc_EditorEngineContext bc_initEditor(bool isActiveAtStart, bc_WindowContext *wc)
     bc_EditorEngineContext newEditor = {
         .isActive = isActiveAtStart,
         .showDemoWindow = false,
-        .frameTimes = calloc(BC_FRAME_HISTORY_LENGTH, sizeof(float))
+        .frameTimes = calloc(MAX(BC_FRAME_HISTORY_LENGTH, BC_MODEL_TIMING_HISTORY_LENGTH), sizeof(float))
     };
 
     return newEditor;
@@ -87,6 +90,20 @@ void bc_drawBaseEditor(bc_EditorEngineContext *eec, bc_WindowContext *wc, bc_Sup
 
         igInputInt("Framerate Limit", (int*)&engineSettings->frameRateLimit, 1, 10, 0);
         igInputInt("Tickrate Limit", (int*)&engineSettings->tickRateLimit, 1, 10, 0);
+        engineSettings->tickRateLimit = MAX(0, (int)engineSettings->tickRateLimit);
+        if (igIsItemHovered(0)) {
+            igSetTooltip("Model steps per second while auto stepping, independent of framerate. 0 for unlimited");
+        }
+        igInputInt("Max Tick Lag (ms)", (int*)&engineSettings->maxTickLagMs, 10, 100, 0);
+        engineSettings->maxTickLagMs = MAX(0, (int)engineSettings->maxTickLagMs);
+        if (igIsItemHovered(0)) {
+            igSetTooltip("If the model falls further behind than this, missed steps are dropped instead of run all at once");
+        }
+        igInputInt("Model Worker Threads", (int*)&engineSettings->modelWorkerThreads, 1, 4, 0);
+        engineSettings->modelWorkerThreads = MAX(0, (int)engineSettings->modelWorkerThreads);
+        if (igIsItemHovered(0)) {
+            igSetTooltip("Applied on next model start");
+        }
         // TODO: option to save engine settings
 
         igCheckbox("Demo Window", &eec->showDemoWindow);
@@ -133,6 +150,79 @@ void bc_drawBaseEditor(bc_EditorEngineContext *eec, bc_WindowContext *wc, bc_Sup
 
             igValue_Float("Avg fps", 1.0 / avgTime, "%.1f");
         }
+        // Model step, phase, and system times. Recorded by the model thread, so entries are per model step instead of per frame
+        if (igCollapsingHeader_TreeNodeFlags("Model", ImGuiTreeNodeFlags_DefaultOpen)) {
+            const bc_ModelTimingHistory *timings = &superInfo->modelTimings;
+            u32 entryCount = bc_modelTimingEntryCount(timings);
+            if (entryCount == 0) {
+                igText("No model steps recorded");
+            } else {
+                SDL_MemoryBarrierAcquire();
+                u32 newest = (SDL_AtomicGet((SDL_atomic_t*)&timings->recordedSteps) - 1) % BC_MODEL_TIMING_HISTORY_LENGTH;
+                plotModelTimes(eec, "Step wall time (ms)", timings->stepTimes, 1, timings, entryCount, newest);
+                if (igTreeNode_Str("Phases (CPU time)")) {
+                    // Phase times are CPU time summed over all worker threads, so they can add up to more than step time
+                    for (int p = 0; p < BC_MODEL_PHASE_COUNT; p++) {
+                        char label[48];
+                        snprintf(label, sizeof(label), "%s CPU (ms)", bc_modelPhaseNames[p]);
+                        plotModelTimes(eec, label, &timings->phaseTimes[0][p], BC_MODEL_PHASE_COUNT, timings, entryCount, newest);
+                    }
+                    igTreePop();
+                }
+                if (igTreeNode_Str("Systems")) {
+                    drawModelSystemTable(timings);
+                    igTreePop();
+                }
+            }
+        }
     }
     igEnd();
 }
+
+// times is read with stride, so columns of 2D arrays can be plotted directly
+static void plotModelTimes(bc_EditorEngineContext *eec, const char *label, const u64 *times, size_t stride, const bc_ModelTimingHistory *timings, u32 entryCount, u32 newest) {
+    float sumOfTimes = 0.0;
+    float maxDuration = 0.0;
+    // oldest to newest
+    u32 oldest = (newest + BC_MODEL_TIMING_HISTORY_LENGTH + 1 - entryCount) % BC_MODEL_TIMING_HISTORY_LENGTH;
+    for (int i = 0; i < entryCount; i++) {
+        u32 entry = (oldest + i) % BC_MODEL_TIMING_HISTORY_LENGTH;
+        float ms = ((float)times[entry * stride] / timings->performanceFrequency) * 1000.0;
+        eec->frameTimes[i] = ms;
+        maxDuration = fmaxf(maxDuration, ms);
+        sumOfTimes += ms;
+    }
+    char overlay[32];
+    sprintf(overlay, "avg: %.2fms", sumOfTimes / entryCount);
+    igPlotLines_FloatPtr(label, eec->frameTimes, entryCount, 0, overlay, 0.0, maxDuration, (ImVec2){0, 0}, sizeof(float));
+}
+
+static void drawModelSystemTable(const bc_ModelTimingHistory *timings) {
+    u32 systemCount = timings->systemCount;
+    float averages[BC_MODEL_TIMING_MAX_SYSTEMS];
+    float maxes[BC_MODEL_TIMING_MAX_SYSTEMS];
+    u32 order[BC_MODEL_TIMING_MAX_SYSTEMS];
+    // Slowest first
+    bc_modelTimingSystemAverages(timings, averages, maxes, order);
+
+    if (igBeginTable("Model Systems", 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_SizingStretchProp, (ImVec2){0, 0}, 0.0)) {
+        igTableSetupColumn("System", 0, 0.0, 0);
+        igTableSetupColumn("Phase", 0, 0.0, 0);
+        igTableSetupColumn("Avg CPU ms", 0, 0.0, 0);
+        igTableSetupColumn("Max CPU ms", 0, 0.0, 0);
+        igTableHeadersRow();
+        for (int i = 0; i < systemCount; i++) {
+            u32 s = order[i];
+            igTableNextRow(0, 0.0);
+            igTableNextColumn();
+            igText("%s", timings->systemNames[s]);
+            igTableNextColumn();
+            igText("%s", bc_modelPhaseNames[timings->systemPhases[s]]);
+            igTableNextColumn();
+            igText("%.3f", averages[s]);
+            igTableNextColumn();
+            igText("%.3f", maxes[s]);
+        }
+        igEndTable();
+    }
+}
@@ -96,6 +96,10 @@ static void mainLoop(void) {
 
     bc_view_processInputState(passthroughMouse, passthroughKeyboard);
 
+    // Model thread reads these on its next scheduled step
+    mctx->tickRate = superContext.engineConfig->tickRateLimit;
+    mctx->maxLagMs = superContext.engineConfig->maxTickLagMs;
+
     bc_view_beginFrame(wc);
     bc_view_drawFrame(superContext.superInterface, wc);
 
@@ -109,6 +113,11 @@ static void mainLoop(void) {
     }
     bc_endEditor();
 
+    if (viewHasReceivedModel) {
+        // Every model_tryLock for this frame is done
+        model_endLockRequests(mctx);
+    }
+
     bc_view_endFrame(wc);
 
     // handle superInterface signals
@@ -181,15 +190,16 @@ int bc_startEngine(bc_StartupSettings startSettings) {
             .mutex = SDL_CreateMutex(),
             .cond =SDL_CreateCond(),
             .deltaTime = 1.0, // TODO: temporary until view has a mechanism to set this
+            .timings = &superInfo.modelTimings,
         },
     };
 
-    // TODO: track logic thread timing in module code
-    //superInfo->tickDurations = calloc(bc_frameHistoryLength, sizeof(superInfo->tickDurations[0]));
-    //superInfo->worldStepHistory = calloc(bc_frameHistoryLength, sizeof(superInfo->worldStepHistory[0]));
-
     superContext.superInterface->signal = BC_SUPERVISOR_SIGNAL_NONE;
 
+    if (startSettings.modelWorkerThreads >= 0) {
+        superContext.engineConfig->modelWorkerThreads = startSettings.modelWorkerThreads;
+    }
+
     //u32 frameInterval = 1000 / superContext.engineConfig->frameRateLimit;
 
     windowContext = bc_createWindow(1280, 720);
@@ -247,6 +257,8 @@ bc_EngineSettings *loadEngineConfig(char *path) {
      *engineConfig = (bc_EngineSettings){
         .frameRateLimit = 120,
         .tickRateLimit = 100,
+        .maxTickLagMs = 250,
+        .modelWorkerThreads = 0,
     };
     return engineConfig;
 }
@@ -274,6 +286,7 @@ void startModel(int argc, char *argv[], SuperContext *sc) {
         .argc = argc,
         .argv = argv,
         .isModelDataReady = &sc->isModelDataReady,
+        .workerThreads = sc->engineConfig->modelWorkerThreads,
         .modelContext = &sc->modelContext,
     };
     sc->modelThread = SDL_CreateThread(bc_model_run, "model", modelInput);
@@ -301,9 +314,13 @@ void continueModel() {
 }
 
 void requestModelStop(bc_ModelContext *modelData) {
+    // Set before locking, so a running batch stops at its next step and releases the lock
     modelData->shouldStopModel = true;
+    SDL_LockMutex(modelData->mutex);
     modelData->runForSteps = 0;
+    modelData->autoStep = false;
     SDL_CondSignal(modelData->cond);
+    SDL_UnlockMutex(modelData->mutex);
 }
 
 void requestProcessStop(bc_ProcessState *appState, bc_ModelContext *modelData) {
@@ -15,16 +15,20 @@ typedef struct {
     char *loadModelPath;
     size_t startModelArgCount;
     char **startModelArgs;
+    s32 modelWorkerThreads; // If >= 0, overrides bc_EngineSettings.modelWorkerThreads
 } bc_StartupSettings;
 
 typedef struct {
     u32 frameRateLimit; // Max rendering fps
-    u32 tickRateLimit; // Max number of logic ticks per second (tps)
+    u32 tickRateLimit; // Target number of logic ticks per second (tps) while the model is auto stepping, 0 for unlimited
+    u32 maxTickLagMs; // Longest the model can fall behind tickRateLimit before missed ticks are dropped instead of caught up
+    u32 modelWorkerThreads; // Number of flecs worker threads used by the model world, applied when the model starts
 } bc_EngineSettings;
 
 typedef struct {
     u64 frameCPUTimes[BC_FRAME_HISTORY_LENGTH]; // time from start to end of main loop SDL_GetPerformanceCounter calls
     u64 frameTotalTimes[BC_FRAME_HISTORY_LENGTH]; // time from start of one main loop iteration to the next
+    bc_ModelTimingHistory modelTimings; // written by the model thread, see bc_modelTiming.h
 } bc_SuperInfo;
 
 int bc_startEngine(bc_StartupSettings startSettings);
@@ -0,0 +1,628 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <SDL2/SDL.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+#include "htw_core.h"
+#include "basaltic_model.h"
+#include "basaltic_worldGen.h"
+#include "bc_cellStore.h"
+#include "basaltic_components.h"
+
+// Runs the model without any window, renderer, or editor. Useful for profiling and long batch simulations
+
+typedef struct {
+    char *dataDirectory;
+    size_t modelArgCount;
+    char **modelArgs;
+    u64 steps;
+    s32 workerThreads;
+    bool quiet;
+    bool profileSystems;
+    u32 layoutBenchPasses; // if > 0, only run the cell layout benchmark
+    u64 hashInterval; // if > 0, run in determinism mode and print the world hash every hashInterval steps
+    s32 determinismThreads; // if > 0, only check that world hashes match on 0 and this many worker threads
+    u64 rateBenchSteps; // if > 0, only run the rate table benchmark
+    u32 laneCheckChunks; // if > 0, only compare SIMD and scalar hydrology on this many chunks
+    u32 fastForwardYears; // if > 0, age terrain by this many years before running steps
+    u32 fastForwardDays; // days per fast forward update
+} bc_HeadlessSettings;
+
+typedef struct {
+    bool quiet;
+    double perfFrequency;
+    u64 startTime;
+    u64 reportInterval; // in hours
+    u64 nextReport;
+} FastForwardReport;
+
+static bc_ModelTimingHistory timings;
+
+static void printTimings(const bc_ModelTimingHistory *history, bool includeSystems);
+static void runCellLayoutBenchmark(u32 passes);
+static void runRateTableBenchmark(const bc_HeadlessSettings *settings);
+static bool runDeterminismCheck(const bc_HeadlessSettings *settings);
+static bool runHydrologyLaneCheck(u32 chunkCount);
+static void reportFastForward(u64 hoursDone, u64 hoursTotal, void *ctx);
+
+static void printUsage(const char *program) {
+    printf("Usage: %s [options]\n"
+           "  -n <seed> [width] [height]  model start args, same as basaltic_engine\n"
+           "  -s <steps>                  number of model steps to run (default 100)\n"
+           "  -t <threads>                number of flecs worker threads (default 0)\n"
+           "  -d <directory>              data directory (default 'data/')\n"
+           "  -q                          only print final summary\n"
+           "  -p                          print per-system times in summary\n"
+           "  -b <passes>                 compare CellData AOS and SOA layouts over <passes> passes per kernel, with cache misses where hardware counters are available, then exit\n"
+           "  -r <steps>                  compare TerrainDailyStep times with and without hydrology rate tables over <steps> steps each, then exit\n"
+           "  -w <interval>               enable determinism mode and print the world hash every <interval> steps\n"
+           "  -c <threads>                run <steps> steps in determinism mode on 0 and on <threads> worker threads, then exit with an error if world hashes differ at any step\n"
+           "  -l <chunks>                 run SIMD and scalar hydrology on <chunks> randomized chunks, then exit with an error if any cell differs by more than the documented tolerance\n"
+           "  -f <years> [days]           age terrain by <years> before running steps, updating every [days] days (1 to 7, default 7)\n"
+           "  -h                          print this message\n",
+           program);
+}
+
+static bc_HeadlessSettings parseArgs(int argc, char *argv[]) {
+    bc_HeadlessSettings settings = {
+        .dataDirectory = "data/",
+        .modelArgCount = 0,
+        .modelArgs = calloc(argc, sizeof(char *)),
+        .steps = 100,
+        .workerThreads = 0,
+        .quiet = false,
+        .profileSystems = false,
+        .layoutBenchPasses = 0,
+        .hashInterval = 0,
+        .determinismThreads = 0,
+        .rateBenchSteps = 0,
+        .laneCheckChunks = 0,
+        .fastForwardYears = 0,
+        .fastForwardDays = 7,
+    };
+
+    // Kept outside the loop so missingValue can report it
+    char *arg = NULL;
+    for (int i = 1; i < argc; i++) {
+        arg = argv[i];
+        if (arg[0] != '-') {
+            fprintf(stderr, "ERROR: no option specified for arg '%s'\n", arg);
+            exit(1);
+        }
+        // all options except flags require at least one value
+        bool hasValue = i + 1 < argc;
+        switch (arg[1]) {
+            case 'n':
+                // collect args until the next switch
+                while (i + 1 < argc && argv[i + 1][0] != '-') {
+                    settings.modelArgs[settings.modelArgCount++] = argv[++i];
+                }
+                break;
+            case 's':
+                if (!hasValue) goto missingValue;
+                settings.steps = strtoull(argv[++i], NULL, 10);
+                break;
+            case 't':
+                if (!hasValue) goto missingValue;
+                settings.workerThreads = MAX(0, atoi(argv[++i]));
+                break;
+            case 'd':
+                if (!hasValue) goto missingValue;
+                settings.dataDirectory = argv[++i];
+                break;
+            case 'q':
+                settings.quiet = true;
+                break;
+            case 'p':
+                settings.profileSystems = true;
+                break;
+            case 'b':
+                if (!hasValue) goto missingValue;
+                settings.layoutBenchPasses = strtoul(argv[++i], NULL, 10);
+                break;
+            case 'r':
+                if (!hasValue) goto missingValue;
+                settings.rateBenchSteps = strtoull(argv[++i], NULL, 10);
+                break;
+            case 'w':
+                if (!hasValue) goto missingValue;
+                settings.hashInterval = strtoull(argv[++i], NULL, 10);
+                break;
+            case 'c':
+                if (!hasValue) goto missingValue;
+                settings.determinismThreads = MAX(0, atoi(argv[++i]));
+                break;
+            case 'l':
+                if (!hasValue) goto missingValue;
+                settings.laneCheckChunks = strtoul(argv[++i], NULL, 10);
+                break;
+            case 'f':
+                if (!hasValue) goto missingValue;
+                settings.fastForwardYears = strtoul(argv[++i], NULL, 10);
+                if (i + 1 < argc && argv[i + 1][0] != '-') {
+                    settings.fastForwardDays = strtoul(argv[++i], NULL, 10);
+                    if (settings.fastForwardDays < 1 || settings.fastForwardDays > CHUNK_LOD_MAX_INTERVAL) {
+                        fprintf(stderr, "ERROR: fast forward days per update must be from 1 to %i, got '%s'\n", CHUNK_LOD_MAX_INTERVAL, argv[i]);
+                        exit(1);
+                    }
+                }
+                break;
+            case 'h':
+                printUsage(argv[0]);
+                exit(0);
+            default:
+                fprintf(stderr, "ERROR: unrecognized option '%s'\n", arg);
+                printUsage(argv[0]);
+                exit(1);
+        }
+    }
+
+    return settings;
+
+missingValue:
+    fprintf(stderr, "ERROR: missing value for option '%s'\n", arg);
+    exit(1);
+}
+
+int main(int argc, char *argv[]) {
+    bc_HeadlessSettings settings = parseArgs(argc, argv);
+    if (chdir(settings.dataDirectory) != 0) {
+        fprintf(stderr, "ERROR: could not change to data directory '%s'\n", settings.dataDirectory);
+        return 1;
+    }
+
+    // Only need timers, never initialize video
+    if (SDL_Init(SDL_INIT_TIMER) != 0) {
+        fprintf(stderr, "Error initializing SDL: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    if (settings.layoutBenchPasses > 0) {
+        runCellLayoutBenchmark(settings.layoutBenchPasses);
+        free(settings.modelArgs);
+        SDL_Quit();
+        return 0;
+    }
+
+    if (settings.rateBenchSteps > 0) {
+        runRateTableBenchmark(&settings);
+        free(settings.modelArgs);
+        SDL_Quit();
+        return 0;
+    }
+
+    if (settings.determinismThreads > 0) {
+        bool match = runDeterminismCheck(&settings);
+        free(settings.modelArgs);
+        SDL_Quit();
+        return match ? 0 : 1;
+    }
+
+    if (settings.laneCheckChunks > 0) {
+        bool match = runHydrologyLaneCheck(settings.laneCheckChunks);
+        free(settings.modelArgs);
+        SDL_Quit();
+        return match ? 0 : 1;
+    }
+
+    double perfFrequency = (double)SDL_GetPerformanceFrequency();
+
+    u64 createStart = SDL_GetPerformanceCounter();
+    bc_ModelContext modelContext = {
+        // Not shared with any other thread, but model functions may expect a valid mutex
+        .mutex = SDL_CreateMutex(),
+        .cond = SDL_CreateCond(),
+        .step = 0,
+        .world = model_createWorld(settings.modelArgCount, settings.modelArgs, settings.workerThreads),
+        .deltaTime = 1.0,
+        .timings = &timings,
+    };
+    bc_instrumentModelSystems(modelContext.world, modelContext.timings);
+    if (settings.hashInterval > 0) {
+        // Keep the seed ParseArgs took from the world seed
+        DeterminismMode determinism = *ecs_singleton_get(modelContext.world, DeterminismMode);
+        determinism.enabled = true;
+        ecs_singleton_set_ptr(modelContext.world, DeterminismMode, &determinism);
+        ecs_singleton_set(modelContext.world, WorldHash, {0});
+    }
+    double createSeconds = (SDL_GetPerformanceCounter() - createStart) / perfFrequency;
+    printf("Model created in %.3fs, running %" PRIu64 " steps on %i worker threads\n", createSeconds, settings.steps, settings.workerThreads);
+    const WorldGenTimings *genTimings = ecs_singleton_get(modelContext.world, WorldGenTimings);
+    if (genTimings != NULL) {
+        printf("World generation: allocate %.2fms, noise %.2fms, erosion %.2fms, smooth %.2fms, %s cache %.2fms\n",
+               genTimings->allocateMs, genTimings->noiseMs, genTimings->erosionMs, genTimings->smoothMs,
+               genTimings->fromCache ? "loaded from" : "saved to", genTimings->cacheMs);
+    }
+
+    if (settings.fastForwardYears > 0) {
+        FastForwardReport report = {
+            .quiet = settings.quiet,
+            .perfFrequency = perfFrequency,
+            .startTime = SDL_GetPerformanceCounter(),
+        };
+        u64 hours = model_fastForwardTerrain(&modelContext, settings.fastForwardYears, settings.fastForwardDays, reportFastForward, &report);
+        double ffSeconds = (SDL_GetPerformanceCounter() - report.startTime) / perfFrequency;
+        printf("Fast forwarded terrain %u years (%" PRIu64 " steps) in %.3fs (%.0f steps/s)\n",
+               settings.fastForwardYears, hours, ffSeconds, hours / ffSeconds);
+    }
+
+    // Report progress roughly 10 times over the whole run
+    u64 reportInterval = MAX(1, settings.steps / 10);
+    u64 runStart = SDL_GetPerformanceCounter();
+    u64 intervalStart = runStart;
+    for (u64 s = 0; s < settings.steps; s++) {
+        model_progressWorld(&modelContext);
+        if (settings.hashInterval > 0 && (s + 1) % settings.hashInterval == 0) {
+            const WorldHash *hash = ecs_singleton_get(modelContext.world, WorldHash);
+            printf("step %" PRIu64 " hash %016" PRIx64 "\n", hash->step, hash->value);
+        }
+        if (!settings.quiet && (s + 1) % reportInterval == 0) {
+            u64 now = SDL_GetPerformanceCounter();
+            double intervalSeconds = (now - intervalStart) / perfFrequency;
+            printf("step %" PRIu64 "/%" PRIu64 ": %.2f steps/s\n", s + 1, settings.steps, reportInterval / intervalSeconds);
+            intervalStart = now;
+        }
+    }
+    double runSeconds = (SDL_GetPerformanceCounter() - runStart) / perfFrequency;
+
+    printf("Ran %" PRIu64 " steps in %.3fs (%.2f steps/s, %.3fms/step)\n",
+           settings.steps, runSeconds,
+           settings.steps / runSeconds,
+           settings.steps == 0 ? 0.0 : (runSeconds * 1000.0) / settings.steps);
+
+    printTimings(&timings, settings.profileSystems);
+
+    model_destroyWorld(modelContext.world);
+    SDL_DestroyCond(modelContext.cond);
+    SDL_DestroyMutex(modelContext.mutex);
+    free(settings.modelArgs);
+
+    SDL_Quit();
+
+    return 0;
+}
+
+static void reportFastForward(u64 hoursDone, u64 hoursTotal, void *ctx) {
+    FastForwardReport *report = ctx;
+    if (report->quiet) {
+        return;
+    }
+    if (report->reportInterval == 0) {
+        // Report progress roughly 10 times over the whole fast forward
+        report->reportInterval = MAX(1, hoursTotal / 10);
+        report->nextReport = report->reportInterval;
+    }
+    if (hoursDone >= report->nextReport || hoursDone == hoursTotal) {
+        double seconds = (SDL_GetPerformanceCounter() - report->startTime) / report->perfFrequency;
+        printf("fast forward %" PRIu64 "/%" PRIu64 " steps: %.0f steps/s\n", hoursDone, hoursTotal, hoursDone / seconds);
+        while (report->nextReport <= hoursDone) {
+            report->nextReport += report->reportInterval;
+        }
+    }
+}
+
+// Averages over the most recent BC_MODEL_TIMING_HISTORY_LENGTH steps
+static void printTimings(const bc_ModelTimingHistory *history, bool includeSystems) {
+    u32 entryCount = bc_modelTimingEntryCount(history);
+    if (entryCount == 0) {
+        return;
+    }
+    double msPerTick = 1000.0 / history->performanceFrequency;
+
+    printf("Average times over last %u steps. Step time is wall time; phase and system times are CPU time summed over all threads, so phases can add up to more than a step:\n", entryCount);
+    u64 stepSum = 0;
+    for (int i = 0; i < entryCount; i++) {
+        stepSum += history->stepTimes[i];
+    }
+    printf("  %-24s %8.3fms wall\n", "Step", (stepSum * msPerTick) / entryCount);
+    for (int p = 0; p < BC_MODEL_PHASE_COUNT; p++) {
+        u64 sum = 0;
+        for (int i = 0; i < entryCount; i++) {
+            sum += history->phaseTimes[i][p];
+        }
+        printf("    %-22s %8.3fms cpu\n", bc_modelPhaseNames[p], (sum * msPerTick) / entryCount);
+    }
+
+    if (!includeSystems) {
+        return;
+    }
+    float averages[BC_MODEL_TIMING_MAX_SYSTEMS];
+    u32 order[BC_MODEL_TIMING_MAX_SYSTEMS];
+    bc_modelTimingSystemAverages(history, averages, NULL, order);
+    printf("Systems, slowest first:\n");
+    for (int i = 0; i < history->systemCount; i++) {
+        u32 s = order[i];
+        printf("  %-32s %-12s %8.3fms cpu\n", history->systemNames[s], bc_modelPhaseNames[history->systemPhases[s]], averages[s]);
+    }
+}
+
+/* Cell layout benchmark
+ * Each kernel touches one or two CellData fields through the bc_CellStore accessors, like most terrain passes do. Reports throughput, and L1 data and last level cache misses per cell where hardware counters are available (Linux, with perf_event_paranoid low enough for the user)
+ */
+
+#define LAYOUT_BENCH_CHUNK_SIZE 64
+#define LAYOUT_BENCH_CHUNK_COUNT 16
+
+typedef s64 (*LayoutKernel)(bc_CellStore *store);
+
+typedef enum {
+    CACHE_COUNTER_L1D,
+    CACHE_COUNTER_LAST_LEVEL,
+    CACHE_COUNTER_COUNT
+} CacheCounter;
+
+// Miss counter for the calling thread, or -1 if unavailable
+static int openCacheCounter(CacheCounter counter) {
+#ifdef __linux__
+    struct perf_event_attr attr = {
+        .size = sizeof(attr),
+        .disabled = 1,
+        .exclude_kernel = 1,
+        .exclude_hv = 1,
+    };
+    if (counter == CACHE_COUNTER_L1D) {
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    } else {
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    }
+    return syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#else
+    return -1;
+#endif
+}
+
+static void startCacheCounter(int fd) {
+#ifdef __linux__
+    if (fd >= 0) {
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+}
+
+// Returns -1 if the counter is unavailable
+static s64 stopCacheCounter(int fd) {
+#ifdef __linux__
+    u64 count;
+    if (fd >= 0) {
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(fd, &count, sizeof(count)) == sizeof(count)) {
+            return count;
+        }
+    }
+#endif
+    return -1;
+}
+
+static void closeCacheCounter(int fd) {
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+// Read one small field, like smoothing does with height
+static s64 kernelSumHeight(bc_CellStore *store) {
+    s64 sum = 0;
+    for (u32 c = 0; c < store->chunkCount; c++) {
+        for (u32 i = 0; i < store->cellsPerChunk; i++) {
+            sum += bc_cellGet_height(store, c, i);
+        }
+    }
+    return sum;
+}
+
+// Read one bitfield struct, like river passes scanning for waterways
+static s64 kernelCountWaterways(bc_CellStore *store) {
+    s64 count = 0;
+    for (u32 c = 0; c < store->chunkCount; c++) {
+        for (u32 i = 0; i < store->cellsPerChunk; i++) {
+            count += bc_hasAnyWaterways(bc_cellGet_waterways(store, c, i));
+        }
+    }
+    return count;
+}
+
+// Read two fields and write one, like the hydrology step
+static s64 kernelDrainGroundwater(bc_CellStore *store) {
+    s64 drained = 0;
+    for (u32 c = 0; c < store->chunkCount; c++) {
+        for (u32 i = 0; i < store->cellsPerChunk; i++) {
+            s64 groundwater = bc_cellGet_groundwater(store, c, i);
+            s64 loss = bc_cellGet_height(store, c, i) < 0 ? groundwater : 1;
+            bc_cellSet_groundwater(store, c, i, CLAMP(groundwater - loss, INT16_MIN, INT16_MAX));
+            drained += loss;
+        }
+    }
+    return drained;
+}
+
+static void runCellLayoutBenchmark(u32 passes) {
+    const struct {
+        const char *name;
+        LayoutKernel kernel;
+        size_t fieldBytes;
+    } kernels[] = {
+        {"sum height", kernelSumHeight, sizeof(((CellData*)0)->height)},
+        {"count waterways", kernelCountWaterways, sizeof(((CellData*)0)->waterways)},
+        {"drain groundwater", kernelDrainGroundwater, sizeof(((CellData*)0)->height) + sizeof(((CellData*)0)->groundwater)},
+    };
+    const char *layoutNames[] = {"AOS", "SOA"};
+
+    htw_ChunkMap *cm = bc_createTerrain(LAYOUT_BENCH_CHUNK_SIZE, LAYOUT_BENCH_CHUNK_COUNT, LAYOUT_BENCH_CHUNK_COUNT);
+    bc_generateTerrain(cm, 0, NULL, NULL);
+    u64 cellCount = (u64)cm->cellsPerChunk * LAYOUT_BENCH_CHUNK_COUNT * LAYOUT_BENCH_CHUNK_COUNT;
+    double perfFrequency = (double)SDL_GetPerformanceFrequency();
+
+    int counters[CACHE_COUNTER_COUNT];
+    bool anyCounters = false;
+    for (int i = 0; i < CACHE_COUNTER_COUNT; i++) {
+        counters[i] = openCacheCounter(i);
+        anyCounters |= counters[i] >= 0;
+    }
+
+    printf("Cell layout benchmark: %" PRIu64 " cells, %zu byte CellData, %u passes per kernel\n", cellCount, sizeof(CellData), passes);
+    if (!anyCounters) {
+        printf("Hardware cache counters unavailable, only reporting throughput\n");
+    }
+    printf("  %-20s %-6s %10s %12s %14s %14s %14s\n", "Kernel", "Layout", "ms/pass", "Mcells/s", "bytes/cell", "L1D miss/cell", "LLC miss/cell");
+    // Keeps results live so kernels aren't optimized away
+    volatile s64 sink = 0;
+    for (int k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+        for (bc_CellLayout layout = BC_CELL_LAYOUT_AOS; layout <= BC_CELL_LAYOUT_SOA; layout++) {
+            bc_CellStore store = bc_createCellStore(cm, layout);
+            // Warm up once so both layouts start with the same cache and page state
+            sink += kernels[k].kernel(&store);
+            for (int i = 0; i < CACHE_COUNTER_COUNT; i++) {
+                startCacheCounter(counters[i]);
+            }
+            u64 start = SDL_GetPerformanceCounter();
+            for (u32 p = 0; p < passes; p++) {
+                sink += kernels[k].kernel(&store);
+            }
+            double seconds = (SDL_GetPerformanceCounter() - start) / perfFrequency;
+            char misses[CACHE_COUNTER_COUNT][16];
+            for (int i = 0; i < CACHE_COUNTER_COUNT; i++) {
+                s64 count = stopCacheCounter(counters[i]);
+                if (count < 0) {
+                    snprintf(misses[i], sizeof(misses[i]), "-");
+                } else {
+                    snprintf(misses[i], sizeof(misses[i]), "%.4f", (double)count / (cellCount * passes));
+                }
+            }
+            // Bytes streamed through the cache per cell: whole struct for AOS, only touched fields for SOA
+            size_t bytesPerCell = layout == BC_CELL_LAYOUT_AOS ? sizeof(CellData) : kernels[k].fieldBytes;
+            printf("  %-20s %-6s %10.3f %12.1f %14zu %14s %14s\n",
+                   kernels[k].name, layoutNames[layout],
+                   (seconds * 1000.0) / passes,
+                   (cellCount * passes) / (seconds * 1000000.0),
+                   bytesPerCell,
+                   misses[CACHE_COUNTER_L1D], misses[CACHE_COUNTER_LAST_LEVEL]);
+            bc_destroyCellStore(&store);
+        }
+    }
+    for (int i = 0; i < CACHE_COUNTER_COUNT; i++) {
+        closeCacheCounter(counters[i]);
+    }
+    bc_destroyTerrain(cm);
+}
+
+/* Rate table benchmark
+ * Runs the same world with hydrology rate tables enabled and disabled, and compares the average time of a TerrainDailyStep run. Only the last BC_MODEL_TIMING_HISTORY_LENGTH steps of each run are recorded
+ */
+
+// Average over the steps where the system ran, in ms
+static double averageSystemRunTime(const bc_ModelTimingHistory *history, const char *systemName) {
+    u32 entryCount = bc_modelTimingEntryCount(history);
+    for (int s = 0; s < history->systemCount; s++) {
+        if (strcmp(history->systemNames[s], systemName) != 0) {
+            continue;
+        }
+        u64 sum = 0;
+        u32 runs = 0;
+        for (int i = 0; i < entryCount; i++) {
+            if (history->systemTimes[i][s] > 0) {
+                sum += history->systemTimes[i][s];
+                runs++;
+            }
+        }
+        return runs == 0 ? 0.0 : (sum * 1000.0) / (history->performanceFrequency * (double)runs);
+    }
+    return 0.0;
+}
+
+static void runRateTableBenchmark(const bc_HeadlessSettings *settings) {
+    const RateTableResolution resolutions[] = {
+        {.temperatureBuckets = 256, .vegetationBuckets = 256},
+        {.temperatureBuckets = 0, .vegetationBuckets = 0},
+    };
+    const char *labels[] = {"Rate tables (256 x 256)", "Exact rates"};
+    double averages[2];
+
+    printf("TerrainDailyStep over %" PRIu64 " steps on %i worker threads:\n", settings->rateBenchSteps, settings->workerThreads);
+    for (int r = 0; r < 2; r++) {
+        ecs_world_t *world = model_createWorld(settings->modelArgCount, settings->modelArgs, settings->workerThreads);
+        ecs_singleton_set_ptr(world, RateTableResolution, &resolutions[r]);
+        bc_instrumentModelSystems(world, &timings);
+        for (u64 s = 0; s < settings->rateBenchSteps; s++) {
+            bc_progressTimed(world, &timings, 1.0);
+        }
+        averages[r] = averageSystemRunTime(&timings, "TerrainDailyStep");
+        printf("  %-26s %8.3fms per run\n", labels[r], averages[r]);
+        model_destroyWorld(world);
+    }
+
+    if (averages[0] > 0.0) {
+        printf("Speedup with rate tables: %.2fx\n", averages[1] / averages[0]);
+    } else {
+        printf("TerrainDailyStep didn't run; use at least 24 steps\n");
+    }
+}
+
+/* Determinism check
+ * Runs the same world twice in determinism mode, once without worker threads and once with settings->determinismThreads, and compares the WorldHash after every step. Worlds run one after another, so only one is ever in memory
+ */
+
+static u64 *runHashedSteps(const bc_HeadlessSettings *settings, s32 workerThreads) {
+    ecs_world_t *world = model_createWorld(settings->modelArgCount, settings->modelArgs, workerThreads);
+    // Keep the seed ParseArgs took from the world seed
+    DeterminismMode determinism = *ecs_singleton_get(world, DeterminismMode);
+    determinism.enabled = true;
+    ecs_singleton_set_ptr(world, DeterminismMode, &determinism);
+    ecs_singleton_set(world, WorldHash, {0});
+
+    u64 *hashes = malloc(sizeof(u64) * settings->steps);
+    for (u64 s = 0; s < settings->steps; s++) {
+        ecs_progress(world, 1.0);
+        hashes[s] = ecs_singleton_get(world, WorldHash)->value;
+    }
+    model_destroyWorld(world);
+    return hashes;
+}
+
+static bool runDeterminismCheck(const bc_HeadlessSettings *settings) {
+    printf("Determinism check: %" PRIu64 " steps on 0 and %i worker threads\n", settings->steps, settings->determinismThreads);
+    u64 *serial = runHashedSteps(settings, 0);
+    u64 *threaded = runHashedSteps(settings, settings->determinismThreads);
+
+    u64 mismatches = 0;
+    for (u64 s = 0; s < settings->steps; s++) {
+        if (serial[s] != threaded[s]) {
+            if (mismatches == 0) {
+                printf("FAILED: first mismatch after step %" PRIu64 ": %016" PRIx64 " vs %016" PRIx64 "\n", s + 1, serial[s], threaded[s]);
+            }
+            mismatches++;
+        }
+    }
+    if (mismatches > 0) {
+        printf("%" PRIu64 " of %" PRIu64 " step hashes differ\n", mismatches, settings->steps);
+    } else if (settings->steps > 0) {
+        printf("World hashes match after every step, final %016" PRIx64 "\n", serial[settings->steps - 1]);
+    }
+
+    free(serial);
+    free(threaded);
+    return mismatches == 0;
+}
+
+static bool runHydrologyLaneCheck(u32 chunkCount) {
+    bc_HydrologyLaneReport report;
+    bool match = bc_compareHydrologyLanes(chunkCount, 0, &report);
+    if (report.lanes == 0) {
+        printf("Hydrology lane check: built without SSE4.1 or AVX2, comparing the scalar path with itself\n");
+    } else {
+        printf("Hydrology lane check: %u lanes\n", report.lanes);
+    }
+    printf("%" PRIu64 " cells compared, largest water difference %i, largest tracks difference %i\n", report.cellsCompared, report.maxWaterError, report.maxTracksError);
+    if (!match) {
+        printf("FAILED: %" PRIu64 " cells outside tolerance\n", report.failedCells);
+    }
+    return match;
+}
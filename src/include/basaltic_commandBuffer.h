@@ -5,6 +5,9 @@
  * The main thread's 'input' command queue has commands added by the main thread, and is periodically emptied by the logic thread
  * The logic thread's 'processing' command queue is processed from start to finish (index 0..itemsInBuffer) every logic tick, and only after the processing queue is cleared the logic thread copies all items from the input queue into the processing queue (clearing the input queue)
  *
+ * Ring mode (bc_createCommandRing):
+ * A single buffer shared by exactly one producer thread and one consumer thread, without any locks. Commands are stored as variable size records in a circular arena; the consumer reads them in place between bc_beginBufferProcessing and bc_endBufferProcessing, so there is no transfer step and no copy after the push. Space is only returned to the producer at bc_endBufferProcessing, so pushes fail while the ring is full rather than waiting
+ *
  */
 
 #ifndef BASALTIC_COMMANDBUFFER_H_INCLUDED
@@ -20,12 +23,19 @@ static const size_t bc_commandBufferMaxArenaSize = 1 << 24; // = 4 MB
 typedef struct private_bc_CommandBuffer* bc_CommandBuffer;
 
 bc_CommandBuffer bc_createCommandBuffer(u32 maxCommandsInBuffer, size_t arenaSize);
+/**
+ * @brief Create a lock-free single producer, single consumer command buffer. See note above
+ *
+ * @param ringSize size of the ring in bytes, rounded up to a power of 2. Each command uses its size plus an 8 byte header, rounded up to 8 bytes
+ * @return new command buffer in ring mode
+ */
+bc_CommandBuffer bc_createCommandRing(size_t ringSize);
 void bc_destroyCommandBuffer(bc_CommandBuffer commandBuffer);
 
 bool bc_commandBufferIsEmpty(bc_CommandBuffer commandBuffer);
 
 /**
- * @brief Attempt to add command to the end of commandBuffer. Will wait for commandBuffer to be unlocked, and lock the buffer while adding command
+ * @brief Attempt to add command to the end of commandBuffer. Will wait for commandBuffer to be unlocked, and lock the buffer while adding command. In ring mode, never locks; only call from the producer thread
  *
  * @param commandData
  * @param size
@@ -34,7 +44,7 @@ bool bc_commandBufferIsEmpty(bc_CommandBuffer commandBuffer);
 bool bc_pushCommandToBuffer(bc_CommandBuffer commandBuffer, const void* commandData, const size_t size);
 
 /**
- * @brief Attempt to copy all commands from src to dst, then empty src. Will wait for locks on both buffers to be released, and lock both buffers while copying
+ * @brief Attempt to copy all commands from src to dst, then empty src. Will wait for locks on both buffers to be released, and lock both buffers while copying. Not supported in ring mode, the consumer should process the ring directly
  *
  * @param dst p_dst:...
  * @param src p_src:...
@@ -42,12 +52,18 @@ bool bc_pushCommandToBuffer(bc_CommandBuffer commandBuffer, const void* commandD
  */
 bool bc_transferCommandBuffer(bc_CommandBuffer dst, bc_CommandBuffer src);
 
+/**
+ * @brief Lock commandBuffer and start reading from the first command. In ring mode, never locks; only call from the consumer thread. Commands pushed after this call are left for the next round of processing
+ *
+ * @return number of commands available to read
+ */
 u32 bc_beginBufferProcessing(bc_CommandBuffer commandBuffer);
 
+/// Returns a pointer to the next command's data, which is valid until bc_endBufferProcessing, or NULL when there are no more commands
 void *bc_getNextCommand(bc_CommandBuffer commandBuffer);
 
 /**
- * @brief Empties and unlocks commandBuffer
+ * @brief Empties and unlocks commandBuffer. In ring mode, releases the space used by all commands available since bc_beginBufferProcessing back to the producer
  *
  * @param commandBuffer p_commandBuffer:...
  */
@@ -25,6 +25,7 @@ bc_StartupSettings parseArgs(int argc, char *argv[]) {
         .loadModelPath = calloc(maxPathLength, sizeof(char)),
         .startModelArgCount = 0,
         .startModelArgs = calloc(maxStartModelArgCount, sizeof(char *)),
+        .modelWorkerThreads = -1,
     };
 
     // default settings
@@ -66,6 +67,10 @@ bc_StartupSettings parseArgs(int argc, char *argv[]) {
                 case 'e':
                     settings.enableEditor = true;
                     break;
+                case 't':
+                    settings.modelWorkerThreads = MAX(0, atoi(argv[i + 1]));
+                    i++;
+                    break;
                 default:
                     fprintf(stderr, "ERROR: unrecognized option '%s'\n", arg);
                     exit(1);
@@ -1,20 +1,33 @@
 #include <SDL2/SDL.h>
 #include "basaltic_model.h"
+#include "bc_modelSnapshot.h"
 #include "basaltic_components.h"
 #include "basaltic_systems.h"
+#include "basaltic_phases.h"
 
-ecs_world_t *model_createWorld(int argc, char *argv[]) {
+// States of bc_ModelContext.lockRequest
+enum {
+    LOCK_REQUEST_NONE,
+    LOCK_REQUEST_PENDING, // another thread failed to lock, the model should yield at its next step boundary
+    LOCK_REQUEST_YIELDING, // model is waiting with the mutex released
+    LOCK_REQUEST_SERVED, // requesting thread has locked since the model started yielding, waiting for model_endLockRequests
+};
+
+ecs_world_t *model_createWorld(int argc, char *argv[], int workerThreads) {
 #ifdef FLECS_SANITIZE
     printf("Initializing flecs in sanitizing mode. Expect a significant slowdown.\n");
 #endif
     ecs_world_t *world = ecs_init();
-    // TODO: configuration for model worker threads
-    //ecs_set_threads(newWorld->ecsWorld, 4);
-    //ecs_set_stage_count(newWorld->ecsWorld, 2);
+    if (workerThreads > 0) {
+        printf("Starting model with %i worker threads\n", workerThreads);
+        ecs_set_threads(world, workerThreads);
+    }
     ECS_IMPORT(world, Bc);
     ECS_IMPORT(world, BcSystems);
 
     ecs_singleton_set(world, Args, {argc, argv});
+    // Same number of helpers as flecs workers, for systems that split work within one entity
+    ecs_singleton_set(world, JobPool, {bc_createJobPool(MAX(0, workerThreads))});
 
     // TODO: script setup as part of a "game" module?
     //ecs_plecs_from_file(world, "model/plecs/startup/startup_test.flecs");
@@ -28,17 +41,83 @@ ecs_world_t *model_createWorld(int argc, char *argv[]) {
 }
 
 void model_progressWorld(bc_ModelContext *mctx) {
-    Uint64 startTime = SDL_GetTicks64();
-    ecs_progress(mctx->world, mctx->deltaTime);
-    // get tick duration for stats
-    Uint64 endTime = SDL_GetTicks64();
-    Uint64 duration = endTime - startTime;
-    // TODO: where to store model performance stats?
+    if (mctx->timings != NULL) {
+        bc_progressTimed(mctx->world, mctx->timings, mctx->deltaTime);
+    } else {
+        ecs_progress(mctx->world, mctx->deltaTime);
+    }
     mctx->step++;
 }
 
+void model_applyCommands(bc_ModelContext *mctx) {
+    ecs_run_pipeline(mctx->world, ApplyCommandsPipeline, 0.0);
+}
+
+u64 model_fastForwardTerrain(bc_ModelContext *mctx, u32 years, u32 daysPerUpdate, bc_FastForwardProgress progress, void *progressCtx) {
+    u64 hours = bc_fastForwardTerrain(mctx->world, years, daysPerUpdate, progress, progressCtx);
+    mctx->step += hours;
+    return hours;
+}
+
 void model_destroyWorld(ecs_world_t *world) {
+    const JobPool *jobs = ecs_singleton_get(world, JobPool);
+    bc_JobPool *pool = jobs == NULL ? NULL : jobs->pool;
     ecs_fini(world);
+    if (pool != NULL) {
+        bc_destroyJobPool(pool);
+    }
+}
+
+bool model_tryLock(bc_ModelContext *mctx) {
+    if (SDL_TryLockMutex(mctx->mutex) == 0) {
+        // Either the model was already idle, or it is yielding for this thread
+        SDL_AtomicCAS(&mctx->lockRequest, LOCK_REQUEST_PENDING, LOCK_REQUEST_NONE);
+        SDL_AtomicCAS(&mctx->lockRequest, LOCK_REQUEST_YIELDING, LOCK_REQUEST_SERVED);
+        return true;
+    }
+    SDL_AtomicCAS(&mctx->lockRequest, LOCK_REQUEST_NONE, LOCK_REQUEST_PENDING);
+    return false;
+}
+
+void model_endLockRequests(bc_ModelContext *mctx) {
+    if (SDL_AtomicCAS(&mctx->lockRequest, LOCK_REQUEST_SERVED, LOCK_REQUEST_NONE)) {
+        // Taking the lock first means the model is waiting on cond, so the signal can't be missed
+        SDL_LockMutex(mctx->mutex);
+        SDL_CondSignal(mctx->cond);
+        SDL_UnlockMutex(mctx->mutex);
+    }
+}
+
+// Release the mutex until other threads waiting for it have had a turn, if any asked and the model hasn't paused recently
+static void yieldToLockRequests(bc_ModelContext *mctx) {
+    if (SDL_AtomicGet(&mctx->lockRequest) != LOCK_REQUEST_PENDING) {
+        return;
+    }
+    u64 now = SDL_GetTicks64();
+    if (now < mctx->lastYieldTime + BC_MODEL_YIELD_INTERVAL_MS) {
+        return;
+    }
+    SDL_AtomicSet(&mctx->lockRequest, LOCK_REQUEST_YIELDING);
+    u64 deadline = now + BC_MODEL_YIELD_MAX_MS;
+    while (SDL_AtomicGet(&mctx->lockRequest) != LOCK_REQUEST_NONE && !mctx->shouldStopModel && now < deadline) {
+        SDL_CondWaitTimeout(mctx->cond, mctx->mutex, deadline - now);
+        now = SDL_GetTicks64();
+    }
+    SDL_AtomicSet(&mctx->lockRequest, LOCK_REQUEST_NONE);
+    mctx->lastYieldTime = now;
+}
+
+// Run up to count steps, stopping early if the model is asked to stop. If publishLast, always publish after the final step so the view doesn't miss the end of a manual batch
+static void runSteps(bc_ModelContext *mctx, u64 count, bool publishLast) {
+    for (u64 i = 0; i < count && !mctx->shouldStopModel; i++) {
+        model_progressWorld(mctx);
+        // Copying the model is relatively expensive, skip it while the view hasn't taken the last snapshot
+        bool isLastStep = i >= count - 1;
+        if ((publishLast && isLastStep) || !bc_isModelSnapshotPending(mctx->snapshots)) {
+            bc_publishModelSnapshot(mctx->snapshots, mctx->world, mctx->step);
+        }
+        yieldToLockRequests(mctx);
+    }
 }
 
 int bc_model_run(void* in) {
@@ -48,19 +127,83 @@ int bc_model_run(void* in) {
 
     SDL_LockMutex(modelContext->mutex);
 
-    modelContext->world = model_createWorld(threadInput->argc, threadInput->argv);
+    modelContext->world = model_createWorld(threadInput->argc, threadInput->argv, threadInput->workerThreads);
+    if (modelContext->timings != NULL) {
+        bc_instrumentModelSystems(modelContext->world, modelContext->timings);
+    }
+    modelContext->commands = bc_createCommandRing(BC_MODEL_COMMAND_RING_SIZE);
+    ecs_singleton_set(modelContext->world, ModelCommandQueue, {modelContext->commands});
+    modelContext->snapshots = bc_createModelSnapshotBuffer(modelContext->world);
+    bc_publishModelSnapshot(modelContext->snapshots, modelContext->world, modelContext->step);
     *threadInput->isModelDataReady = true;
 
+    modelContext->droppedSteps = 0;
+    SDL_AtomicSet(&modelContext->lockRequest, LOCK_REQUEST_NONE);
+    modelContext->lastYieldTime = 0;
+    u64 perfFrequency = SDL_GetPerformanceFrequency();
+    u64 nextStepTime = 0; // performance counter time when the next scheduled step is due
+    bool wasAutoStepping = false;
     while (!modelContext->shouldStopModel) {
-        // wait to be signaled
-        SDL_CondWait(modelContext->cond, modelContext->mutex);
+        // Manual batches can be requested in either mode
+        if (modelContext->runForSteps > 0) {
+            runSteps(modelContext, modelContext->runForSteps, true);
+            modelContext->runForSteps = 0;
+        }
+
+        if (modelContext->autoStep) {
+            u64 now = SDL_GetPerformanceCounter();
+            if (!wasAutoStepping) {
+                nextStepTime = now;
+                wasAutoStepping = true;
+            }
+            u32 tickRate = modelContext->tickRate;
+            if (tickRate == 0) {
+                // Unlimited. Never sleeps, so other threads only get the lock through model_tryLock requests, which runSteps yields to
+                runSteps(modelContext, 1, false);
+                nextStepTime = SDL_GetPerformanceCounter();
+                continue;
+            }
+
+            u64 interval = MAX(1, perfFrequency / tickRate);
+            if (now >= nextStepTime) {
+                // Catch up on every step that came due since the last batch, unless that would be more than maxLagMs worth
+                u64 dueSteps = ((now - nextStepTime) / interval) + 1;
+                u64 maxSteps = MAX(1, ((u64)modelContext->maxLagMs * tickRate) / 1000);
+                if (dueSteps > maxSteps) {
+                    modelContext->droppedSteps += dueSteps - maxSteps;
+                    dueSteps = maxSteps;
+                    nextStepTime = now + interval;
+                } else {
+                    nextStepTime += dueSteps * interval;
+                }
+                runSteps(modelContext, dueSteps, false);
+            }
 
-        for (int i = 0; i < modelContext->runForSteps; i++) {
-            model_progressWorld(modelContext);
+            // Sleep until the next step is due, rounded up to whole ms. Waking late is fine, the next batch will catch up
+            now = SDL_GetPerformanceCounter();
+            if (nextStepTime > now) {
+                u32 waitMs = (((nextStepTime - now) * 1000) + perfFrequency - 1) / perfFrequency;
+                SDL_CondWaitTimeout(modelContext->cond, modelContext->mutex, waitMs);
+            }
+        } else {
+            wasAutoStepping = false;
+            // Wait to be signaled. Other threads change these while holding the mutex, so checking them first means no signal is missed
+            while (!modelContext->shouldStopModel && modelContext->runForSteps == 0 && !modelContext->autoStep && bc_commandBufferIsEmpty(modelContext->commands)) {
+                SDL_CondWait(modelContext->cond, modelContext->mutex);
+            }
+            // Show edits made while paused right away, instead of on the next step
+            if (!bc_commandBufferIsEmpty(modelContext->commands)) {
+                model_applyCommands(modelContext);
+                bc_publishModelSnapshot(modelContext->snapshots, modelContext->world, modelContext->step);
+            }
         }
     }
     *threadInput->isModelDataReady = false;
+    bc_destroyModelSnapshotBuffer(modelContext->snapshots);
+    modelContext->snapshots = NULL;
     model_destroyWorld(modelContext->world);
+    bc_destroyCommandBuffer(modelContext->commands);
+    modelContext->commands = NULL;
 
     SDL_UnlockMutex(modelContext->mutex);
 
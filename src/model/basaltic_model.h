@@ -3,17 +3,41 @@
 
 #include <stdbool.h>
 #include <SDL2/SDL_mutex.h>
+#include <SDL2/SDL_atomic.h>
+#include "htw_core.h"
 #include "basaltic_defs.h"
+#include "basaltic_commandBuffer.h"
+#include "bc_modelTiming.h"
+#include "systems/basaltic_terrain_systems.h"
 #include "flecs.h"
 
+// Minimum time between pauses for lock requests, so frequent requests can't starve the model
+#define BC_MODEL_YIELD_INTERVAL_MS 100
+// Longest pause for one lock request, in case the requesting thread stops asking
+#define BC_MODEL_YIELD_MAX_MS 100
+
 // NOTE: shared resource. When receiving a pointer to bc_ModelData, MUST lock mutex before use.
 typedef struct {
     SDL_mutex *mutex;
     SDL_cond *cond;
     // Should aquire lock before using other members, but in theory won't break anything to use these out of a lock
     bool shouldStopModel; // set to true then signal cond to stop model thread
-    int runForSteps; // set then signal cond to run model for the specified number of steps
+    int runForSteps; // set then signal cond to run model for the specified number of steps. Ignored while autoStep is set
+    // Fixed timestep scheduling. While autoStep is set, the model thread runs steps on its own clock instead of waiting for runForSteps. Signal cond after setting autoStep so the model thread wakes up
+    bool autoStep;
+    u32 tickRate; // target steps per second while auto stepping, 0 for unlimited
+    u32 maxLagMs; // if the model falls further behind schedule than this, the extra steps are dropped instead of caught up
+    u64 droppedSteps; // total steps dropped by the lag clamp
     uint64_t step; // current model step
+    // Lock requests from other threads, see model_tryLock. Lock-free
+    SDL_atomic_t lockRequest;
+    u64 lastYieldTime; // SDL_GetTicks64 time the model last paused for a lock request, only used by the model thread
+    // Lock-free, can be read from the view at any time while the model is running. See bc_modelSnapshot.h
+    struct bc_ModelSnapshotBuffer *snapshots;
+    // Lock-free single producer ring for edits, see bc_components_commands.h. The view is the only producer. Applied at the start of the next step, or right away while the model is paused if cond is signaled
+    bc_CommandBuffer commands;
+    // Optional, set before starting the model thread to record step and system times. Lock-free, see bc_modelTiming.h
+    bc_ModelTimingHistory *timings;
     // Must aquire lock to use members from here down
     ecs_world_t *world;
     float deltaTime;
@@ -24,9 +48,59 @@ typedef struct {
     int argc;
     char **argv;
     bool *isModelDataReady;
+    int workerThreads; // Number of flecs worker threads for the model world; 0 runs all systems on the model thread
     bc_ModelContext *modelContext; // Shared resource, always lock model.mutex before using
 } bc_ModelThreadInput;
 
+/**
+ * @brief Create and initialize a new model world. Args are passed through to the Args singleton, and are used by ParseArgs to setup the initial world state
+ *
+ * @param argc number of strings in argv
+ * @param argv model start arguments: seed, width, height
+ * @param workerThreads number of flecs worker threads, and of JobPool helper threads. Systems marked multi_threaded are split across workers; if 0, every system runs on the calling thread
+ * @return new world, ready to progress
+ */
+ecs_world_t *model_createWorld(int argc, char *argv[], int workerThreads);
+
+/**
+ * @brief Advance the model world by one step, and increment mctx->step. Records times into mctx->timings if set. Caller must hold mctx->mutex if the context is shared
+ *
+ * @param mctx context containing the world to progress
+ */
+void model_progressWorld(bc_ModelContext *mctx);
+
+/**
+ * @brief Apply queued model commands without advancing the model. Caller must hold mctx->mutex if the context is shared
+ *
+ * @param mctx context containing the world to edit
+ */
+void model_applyCommands(bc_ModelContext *mctx);
+
+/**
+ * @brief Age the world's terrain by years without progressing the pipeline, see bc_fastForwardTerrain. Advances mctx->step by the number of hours simulated. Caller must hold mctx->mutex if the context is shared
+ *
+ * @param mctx context containing the world to fast forward
+ * @param years model years to simulate
+ * @param daysPerUpdate dT of each terrain update in days
+ * @param progress if not NULL, called after every update
+ * @param progressCtx passed to progress
+ * @return number of steps (hours) simulated
+ */
+u64 model_fastForwardTerrain(bc_ModelContext *mctx, u32 years, u32 daysPerUpdate, bc_FastForwardProgress progress, void *progressCtx);
+
+void model_destroyWorld(ecs_world_t *world);
+
+/**
+ * @brief Try to lock mctx->mutex without blocking, for threads other than the model thread. Release with SDL_UnlockMutex. If the model thread is busy, records a request instead, so that the model pauses at a step boundary soon (at most every BC_MODEL_YIELD_INTERVAL_MS) and a later call succeeds even while the model is auto stepping with an unlimited tick rate. The model stays paused until model_endLockRequests is called, so every caller in the same frame gets a turn
+ *
+ * @param mctx shared model context
+ * @return true if the lock was taken
+ */
+bool model_tryLock(bc_ModelContext *mctx);
+
+/// Call once per frame after the last model_tryLock, to let the model resume if it paused for this frame
+void model_endLockRequests(bc_ModelContext *mctx);
+
 /**
  * @brief Entry point for model thread, use with SDL_CreateThread
  *
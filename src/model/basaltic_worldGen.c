@@ -1,24 +1,31 @@
+#include <stdlib.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <direct.h>
+#include <process.h>
+#define getpid _getpid
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
 #include "basaltic_worldGen.h"
+#include "bc_haloChunkMap.h"
+#include "bc_brushStamp.h"
 #include "htw_core.h"
 #include "htw_random.h"
 #include "htw_geomap.h"
 #include "components/basaltic_components_planes.h"
 
 void bc_elevationBrush(htw_ChunkMap *chunkMap, htw_geo_GridCoord pos, s32 value, u32 radius) {
-    u32 area = htw_geo_getHexArea(radius);
-    htw_geo_CubeCoord start = htw_geo_gridToCubeCoord(pos);
-    htw_geo_CubeCoord relative = {0, 0, 0};
-    for (int i = 0; i < area; i++) {
-        //u32 dist = htw_geo_hexMagnitude(relative);
-        float dist = htw_geo_hexCartesianDistance(chunkMap, (htw_geo_GridCoord){0, 0}, htw_geo_cubeToGridCoord(relative));
-        float curve = 1.0 - (1.0 * (dist / radius));
-        curve *= curve;
-        s32 valueHere = curve * value + htw_randInt(2);
-        htw_geo_CubeCoord worldCubeCoord = htw_geo_addCubeCoords(start, relative);
-        htw_geo_GridCoord worldCoord = htw_geo_cubeToGridCoord(worldCubeCoord);
-        CellData *cellData = htw_geo_getCell(chunkMap, worldCoord);
+    const bc_BrushStamp *stamp = bc_getBrushStamp(radius);
+    for (int i = 0; i < stamp->area; i++) {
+        s32 valueHere = stamp->weights[i] * value + htw_randInt(2);
+        CellData *cellData = htw_geo_getCell(chunkMap, htw_geo_addGridCoords(pos, stamp->offsets[i]));
         cellData->height = MAX(cellData->height, valueHere);
-        htw_geo_getNextHexSpiralCoord(&relative);
     }
 }
 
@@ -70,30 +77,272 @@ htw_ChunkMap *bc_createTerrain(u32 chunkSize, u32 chunkCountX, u32 chunkCountY)
     return cm;
 }
 
-void bc_generateTerrain(htw_ChunkMap *cm, u32 seed) {
-    for (int c = 0, y = 0; y < cm->chunkCountY; y++) {
-        for (int x = 0; x < cm->chunkCountX; x++, c++) {
-            CellData *cellData = cm->chunks[c].cellData;
+void bc_destroyTerrain(htw_ChunkMap *cm) {
+    if (cm == NULL) {
+        return;
+    }
+    u32 chunkCount = cm->chunkCountX * cm->chunkCountY;
+    for (int c = 0; c < chunkCount; c++) {
+        free(cm->chunks[c].cellData);
+    }
+    free(cm->chunks);
+    free(cm);
+}
 
-            for (int i = 0; i < cm->cellsPerChunk; i++) {
-                CellData *cell = &cellData[i];
-                htw_geo_GridCoord cellCoord = htw_geo_chunkAndCellToGridCoordinates(cm, c, i);
-                // noise values in 0..1
-                float baseNoise = htw_geo_simplex(cm, cellCoord, seed, 8, 8);
-                float nutrientNoise = htw_geo_simplex(cm, cellCoord, seed + 1, 4, 16);
-                float rainNoise = htw_geo_simplex(cm, cellCoord, seed + 2, 4, 4);
-                cell->height = (baseNoise - 0.5) * 64;
-                cell->visibility = 0;
-                cell->geology = (CellGeology){0};
-                cell->tracks = 0;
-                cell->groundwater = rainNoise * INT16_MAX / 128;
-                cell->surfacewater = 0; //rainNoise * UINT16_MAX / 256;
-                cell->humidityPreference = rainNoise * 8192;
-                cell->understory = nutrientNoise * (float)UINT32_MAX / 16;
-                cell->canopy = nutrientNoise * (float)UINT32_MAX / 128;
+typedef struct {
+    htw_ChunkMap *cm;
+    u32 seed;
+    const u32 *chunks; // if NULL, job index is chunk index
+} TerrainGenJob;
+
+static void generateTerrainJob(void *ctx, u32 index) {
+    TerrainGenJob *job = ctx;
+    htw_ChunkMap *cm = job->cm;
+    u32 chunkIndex = job->chunks == NULL ? index : job->chunks[index];
+    CellData *cellData = cm->chunks[chunkIndex].cellData;
+    for (int i = 0; i < cm->cellsPerChunk; i++) {
+        CellData *cell = &cellData[i];
+        htw_geo_GridCoord cellCoord = htw_geo_chunkAndCellToGridCoordinates(cm, chunkIndex, i);
+        // noise values in 0..1
+        float baseNoise = htw_geo_simplex(cm, cellCoord, job->seed, 8, 8);
+        float nutrientNoise = htw_geo_simplex(cm, cellCoord, job->seed + 1, 4, 16);
+        float rainNoise = htw_geo_simplex(cm, cellCoord, job->seed + 2, 4, 4);
+        cell->height = (baseNoise - 0.5) * 64;
+        cell->visibility = 0;
+        cell->geology = (CellGeology){0};
+        cell->tracks = 0;
+        cell->groundwater = rainNoise * INT16_MAX / 128;
+        cell->surfacewater = 0; //rainNoise * UINT16_MAX / 256;
+        cell->humidityPreference = rainNoise * 8192;
+        cell->waterways = (CellWaterways){0};
+        cell->understory = nutrientNoise * (float)UINT32_MAX / 16;
+        cell->canopy = nutrientNoise * (float)UINT32_MAX / 128;
+    }
+}
+
+void bc_generateTerrain(htw_ChunkMap *cm, u32 seed, bc_JobPool *pool, WorldGenTimings *timings) {
+    TerrainGenJob job = {.cm = cm, .seed = seed, .chunks = NULL};
+    ecs_time_t start = {0};
+    ecs_time_measure(&start);
+    bc_parallelFor(pool, cm->chunkCountX * cm->chunkCountY, generateTerrainJob, &job);
+    if (timings != NULL) {
+        timings->noiseMs = ecs_time_measure(&start) * 1000.0;
+    }
+}
+
+/* Worldgen cache */
+
+#define WORLDGEN_CACHE_MAGIC 0x47574342 // "BCWG"
+
+typedef struct {
+    u32 magic;
+    u32 version;
+    u64 key;
+    u32 chunkSize;
+    u32 chunkCountX;
+    u32 chunkCountY;
+    u32 cellSize; // sizeof(CellData) when written
+} WorldGenCacheHeader;
+
+u64 bc_worldGenKey(const char *seedString, u32 seed, u32 chunkSize, u32 chunkCountX, u32 chunkCountY, const bc_WorldGenOptions *options) {
+    u32 params[] = {
+        seed, chunkSize, chunkCountX, chunkCountY, BC_WORLDGEN_VERSION, sizeof(CellData),
+        options->erosionDroplets, options->erosionSeed,
+        options->smoothIterations, options->smoothMinProminance
+    };
+    u32 seedHash = xxh_hash(0, strlen(seedString), (u8*)seedString);
+    // xxh_hash is 32 bit, so combine two differently seeded passes
+    return ((u64)xxh_hash(seedHash, sizeof(params), (u8*)params) << 32) | xxh_hash(~seedHash, sizeof(params), (u8*)params);
+}
+
+void bc_worldGenCachePath(u64 key, char *out, size_t outSize) {
+    snprintf(out, outSize, "%s/worldgen_%016llx.bin", BC_WORLDGEN_CACHE_DIRECTORY, (unsigned long long)key);
+}
+
+static bool cacheHeaderMatches(const WorldGenCacheHeader *header, const htw_ChunkMap *cm, u64 key) {
+    return header->magic == WORLDGEN_CACHE_MAGIC &&
+        header->version == BC_WORLDGEN_VERSION &&
+        header->key == key &&
+        header->chunkSize == cm->chunkSize &&
+        header->chunkCountX == cm->chunkCountX &&
+        header->chunkCountY == cm->chunkCountY &&
+        header->cellSize == sizeof(CellData);
+}
+
+bool bc_loadTerrainCache(htw_ChunkMap *cm, const char *path, u64 key) {
+    u32 chunkCount = cm->chunkCountX * cm->chunkCountY;
+    size_t chunkBytes = cm->cellsPerChunk * sizeof(CellData);
+    size_t fileSize = sizeof(WorldGenCacheHeader) + (chunkCount * chunkBytes);
+#ifdef _WIN32
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        return false;
+    }
+    WorldGenCacheHeader header;
+    bool loaded = fread(&header, sizeof(header), 1, file) == 1 && cacheHeaderMatches(&header, cm, key);
+    if (loaded) {
+        fseek(file, 0, SEEK_END);
+        loaded = ftell(file) == fileSize;
+        fseek(file, sizeof(header), SEEK_SET);
+    }
+    // Read everything before touching cm, so a read error partway through leaves it unchanged
+    u8 *cells = loaded ? malloc(chunkCount * chunkBytes) : NULL;
+    if (loaded) {
+        loaded = fread(cells, chunkBytes, chunkCount, file) == chunkCount;
+    }
+    fclose(file);
+    if (loaded) {
+        for (u32 c = 0; c < chunkCount; c++) {
+            memcpy(cm->chunks[c].cellData, &cells[c * chunkBytes], chunkBytes);
+        }
+    }
+    free(cells);
+    return loaded;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size != fileSize) {
+        close(fd);
+        return false;
+    }
+    const u8 *data = mmap(NULL, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+    bool loaded = cacheHeaderMatches((const WorldGenCacheHeader*)data, cm, key);
+    if (loaded) {
+        const u8 *cells = data + sizeof(WorldGenCacheHeader);
+        for (u32 c = 0; c < chunkCount; c++) {
+            memcpy(cm->chunks[c].cellData, &cells[c * chunkBytes], chunkBytes);
+        }
+    }
+    munmap((void*)data, fileSize);
+    return loaded;
+#endif
+}
+
+bool bc_saveTerrainCache(const htw_ChunkMap *cm, const char *path, u64 key) {
+#ifdef _WIN32
+    _mkdir(BC_WORLDGEN_CACHE_DIRECTORY);
+#else
+    mkdir(BC_WORLDGEN_CACHE_DIRECTORY, 0755);
+#endif
+    char tempPath[256];
+    snprintf(tempPath, sizeof(tempPath), "%s.%d.tmp", path, (int)getpid());
+    FILE *file = fopen(tempPath, "wb");
+    if (file == NULL) {
+        return false;
+    }
+    WorldGenCacheHeader header = {
+        .magic = WORLDGEN_CACHE_MAGIC,
+        .version = BC_WORLDGEN_VERSION,
+        .key = key,
+        .chunkSize = cm->chunkSize,
+        .chunkCountX = cm->chunkCountX,
+        .chunkCountY = cm->chunkCountY,
+        .cellSize = sizeof(CellData)
+    };
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1;
+    u32 chunkCount = cm->chunkCountX * cm->chunkCountY;
+    for (u32 c = 0; written && c < chunkCount; c++) {
+        written = fwrite(cm->chunks[c].cellData, cm->cellsPerChunk * sizeof(CellData), 1, file) == 1;
+    }
+    written = (fclose(file) == 0) && written;
+#ifdef _WIN32
+    // rename won't replace an existing file on Windows
+    remove(path);
+#endif
+    if (!written || rename(tempPath, path) != 0) {
+        remove(tempPath);
+        return false;
+    }
+    return true;
+}
+
+/* Lazy generation */
+
+bc_LazyChunks *bc_createLazyChunks(htw_ChunkMap *cm, u32 seed) {
+    bc_LazyChunks *lazy = malloc(sizeof(bc_LazyChunks));
+    lazy->seed = seed;
+    lazy->chunkCount = cm->chunkCountX * cm->chunkCountY;
+    lazy->residentCount = 0;
+    lazy->states = calloc(lazy->chunkCount, sizeof(u8));
+    lazy->emptyCells = calloc(cm->cellsPerChunk, sizeof(CellData));
+    // Give back the storage allocated with the chunk map; bc_makeChunksResident allocates it again per chunk
+    for (u32 c = 0; c < lazy->chunkCount; c++) {
+        free(cm->chunks[c].cellData);
+        cm->chunks[c].cellData = lazy->emptyCells;
+    }
+    return lazy;
+}
+
+void bc_destroyLazyChunks(htw_ChunkMap *cm, bc_LazyChunks *lazy) {
+    if (lazy == NULL) {
+        return;
+    }
+    // Leave the chunk map safe to pass to bc_destroyTerrain
+    for (u32 c = 0; c < lazy->chunkCount; c++) {
+        if (cm->chunks[c].cellData == lazy->emptyCells) {
+            cm->chunks[c].cellData = NULL;
+        }
+    }
+    free(lazy->emptyCells);
+    free(lazy->states);
+    free(lazy);
+}
+
+u32 bc_makeChunksResident(const Plane *plane, htw_geo_GridCoord center, u32 chunkRadius, bc_JobPool *pool) {
+    htw_ChunkMap *cm = plane->chunkMap;
+    bc_LazyChunks *lazy = plane->lazyChunks;
+    if (lazy == NULL) {
+        return 0;
+    }
+    u32 centerChunk, centerCell;
+    htw_geo_gridCoordinateToChunkAndCellIndex(cm, center, &centerChunk, &centerCell);
+    // Wider than this would only revisit the same chunks
+    s32 r = MIN((s32)chunkRadius, (s32)MAX(cm->chunkCountX, cm->chunkCountY) / 2);
+
+    // Collect empty chunks in the area and the ring around it. Marking them as border right away skips duplicates where the area wraps onto itself
+    u32 *pending = NULL;
+    u32 pendingCount = 0;
+    for (s32 y = -r - 1; y <= r + 1; y++) {
+        for (s32 x = -r - 1; x <= r + 1; x++) {
+            u32 c = htw_geo_getChunkIndexAtOffset(cm, centerChunk, (htw_geo_GridCoord){x, y});
+            if (lazy->states[c] != LAZY_CHUNK_EMPTY) {
+                continue;
             }
+            if (pending == NULL) {
+                pending = malloc(sizeof(u32) * ((2 * r) + 3) * ((2 * r) + 3));
+            }
+            lazy->states[c] = LAZY_CHUNK_BORDER;
+            pending[pendingCount++] = c;
         }
     }
+    if (pending != NULL) {
+        for (u32 i = 0; i < pendingCount; i++) {
+            cm->chunks[pending[i]].cellData = malloc(cm->cellsPerChunk * sizeof(CellData));
+        }
+        TerrainGenJob job = {.cm = cm, .seed = lazy->seed, .chunks = pending};
+        bc_parallelFor(pool, pendingCount, generateTerrainJob, &job);
+        // The cache was built before these cells had any height
+        plane_UpdateChunksBiotemperature(plane, pending, pendingCount);
+        free(pending);
+    }
+
+    for (s32 y = -r; y <= r; y++) {
+        for (s32 x = -r; x <= r; x++) {
+            u32 c = htw_geo_getChunkIndexAtOffset(cm, centerChunk, (htw_geo_GridCoord){x, y});
+            if (lazy->states[c] != LAZY_CHUNK_RESIDENT) {
+                lazy->states[c] = LAZY_CHUNK_RESIDENT;
+                lazy->residentCount++;
+            }
+        }
+    }
+    return pendingCount;
 }
 
 /* Rivers */
@@ -319,45 +568,255 @@ void bc_removeRiverConnection(htw_ChunkMap *cm, htw_geo_GridCoord a, htw_geo_Gri
     bc_applyRiverConnection(cm, &rc);
 }
 
+/* Erosion */
+
+// Each chunk starts this many droplets per batch. Smaller batches see fresher heights, larger ones have less merge overhead
+#define EROSION_DROPLETS_PER_CHUNK_BATCH 16
+#define EROSION_MAX_STEPS 64
+#define EROSION_EVAPORATION 0.05 // fraction of water lost per step
+#define EROSION_CAPACITY 4.0 // sediment carried per unit of slope and water
+#define EROSION_ERODE_RATE 0.3
+#define EROSION_DEPOSIT_RATE 0.3
+
+typedef struct {
+    u32 cell; // index into ErosionJob.heights
+    float delta;
+} ErosionDelta;
+
+typedef struct {
+    ErosionDelta *items;
+    u32 count;
+    u32 capacity;
+} ErosionDeltaList;
+
+typedef struct {
+    const htw_ChunkMap *cm;
+    const float *heights; // every cell, indexed by (chunkIndex * cellsPerChunk) + cellIndex. Read only during a batch
+    ErosionDeltaList *deltas; // one list per chunk
+    u32 seed;
+    u32 droplets;
+    u32 firstDroplet; // of this batch
+} ErosionJob;
+
+static void addErosionDelta(ErosionDeltaList *list, u32 cell, float delta) {
+    if (list->count == list->capacity) {
+        list->capacity = MAX(256, list->capacity * 2);
+        list->items = realloc(list->items, list->capacity * sizeof(ErosionDelta));
+    }
+    list->items[list->count++] = (ErosionDelta){cell, delta};
+}
 
-void bc_smoothTerrain(htw_ChunkMap *cm, s32 minProminance) {
-    for (int c = 0, y = 0; y < cm->chunkCountY; y++) {
-        for (int x = 0; x < cm->chunkCountX; x++, c++) {
-            CellData *cellData = cm->chunks[c].cellData;
+static u32 erosionCellIndex(const htw_ChunkMap *cm, htw_geo_GridCoord pos) {
+    u32 chunkIndex, cellIndex;
+    htw_geo_gridCoordinateToChunkAndCellIndex(cm, pos, &chunkIndex, &cellIndex);
+    return (chunkIndex * cm->cellsPerChunk) + cellIndex;
+}
 
-            for (int i = 0; i < cm->cellsPerChunk; i++) {
-                CellData *cell = &cellData[i];
-                htw_geo_GridCoord cellCoord = htw_geo_chunkAndCellToGridCoordinates(cm, c, i);
-
-                CellData *lowestNeighbor;
-                s32 lowestElevation = cell->height;
-                s32 prominance = 0;
-                for (int d = 0; d < HEX_DIRECTION_COUNT; d++) {
-                    htw_geo_GridCoord neighborCoord = POSITION_IN_DIRECTION(cellCoord, d);
-                    CellData *neighbor = htw_geo_getCell(cm, neighborCoord);
-                    prominance += cell->height - neighbor->height;
-                    if (neighbor->height < lowestElevation) {
-                        lowestElevation = neighbor->height;
-                        lowestNeighbor = neighbor;
-                    }
-                }
-
-                if (prominance >= minProminance) {
-                    cell->height--;
-                    lowestNeighbor->height++;
-                }
+static void erodeDroplet(const ErosionJob *job, ErosionDeltaList *deltas, u32 chunkIndex, u32 dropletIndex) {
+    const htw_ChunkMap *cm = job->cm;
+    htw_geo_GridCoord pos = htw_geo_chunkAndCellToGridCoordinates(cm, chunkIndex, xxh_hash2d(job->seed, dropletIndex, 0) % cm->cellsPerChunk);
+    u32 cell = erosionCellIndex(cm, pos);
+    float water = 1.0;
+    float sediment = 0.0;
+
+    for (int step = 0; step < EROSION_MAX_STEPS; step++) {
+        float height = job->heights[cell];
+        if (height < 0.0) {
+            // Reached the sea, drop everything
+            break;
+        }
+        htw_geo_GridCoord next = pos;
+        u32 nextCell = cell;
+        float lowest = height;
+        for (int d = 0; d < HEX_DIRECTION_COUNT; d++) {
+            htw_geo_GridCoord neighbor = POSITION_IN_DIRECTION(pos, d);
+            u32 neighborCell = erosionCellIndex(cm, neighbor);
+            if (job->heights[neighborCell] < lowest) {
+                lowest = job->heights[neighborCell];
+                next = neighbor;
+                nextCell = neighborCell;
             }
         }
+        if (nextCell == cell) {
+            // Pit, fill it in
+            break;
+        }
+
+        float slope = height - lowest;
+        float capacity = slope * water * EROSION_CAPACITY;
+        if (sediment < capacity) {
+            // Never dig below the next cell, or droplets would carve pits behind them
+            float eroded = MIN((capacity - sediment) * EROSION_ERODE_RATE, slope);
+            addErosionDelta(deltas, cell, -eroded);
+            sediment += eroded;
+        } else {
+            float deposited = (sediment - capacity) * EROSION_DEPOSIT_RATE;
+            addErosionDelta(deltas, cell, deposited);
+            sediment -= deposited;
+        }
+        water *= 1.0 - EROSION_EVAPORATION;
+        pos = next;
+        cell = nextCell;
+    }
+    if (sediment > 0.0) {
+        addErosionDelta(deltas, cell, sediment);
     }
 }
 
+static void erosionBatchJob(void *ctx, u32 chunkIndex) {
+    ErosionJob *job = ctx;
+    ErosionDeltaList *deltas = &job->deltas[chunkIndex];
+    deltas->count = 0;
+    for (u32 d = 0; d < EROSION_DROPLETS_PER_CHUNK_BATCH; d++) {
+        u32 dropletIndex = job->firstDroplet + (chunkIndex * EROSION_DROPLETS_PER_CHUNK_BATCH) + d;
+        if (dropletIndex >= job->droplets) {
+            break;
+        }
+        erodeDroplet(job, deltas, chunkIndex, dropletIndex);
+    }
+}
 
+void bc_erodeTerrain(htw_ChunkMap *cm, u32 droplets, u32 seed, bc_JobPool *pool) {
+    u32 chunkCount = cm->chunkCountX * cm->chunkCountY;
+    size_t cellCount = (size_t)chunkCount * cm->cellsPerChunk;
+    // Erosion moves fractions of a height step, so work on a float copy and round once at the end
+    float *heights = malloc(cellCount * sizeof(float));
+    for (u32 c = 0; c < chunkCount; c++) {
+        const CellData *cells = cm->chunks[c].cellData;
+        for (u32 i = 0; i < cm->cellsPerChunk; i++) {
+            heights[(c * cm->cellsPerChunk) + i] = cells[i].height;
+        }
+    }
 
+    ErosionJob job = {
+        .cm = cm,
+        .heights = heights,
+        .deltas = calloc(chunkCount, sizeof(ErosionDeltaList)),
+        .seed = seed,
+        .droplets = droplets,
+    };
+    u32 batchSize = chunkCount * EROSION_DROPLETS_PER_CHUNK_BATCH;
+    for (job.firstDroplet = 0; job.firstDroplet < droplets; job.firstDroplet += batchSize) {
+        bc_parallelFor(pool, chunkCount, erosionBatchJob, &job);
+        // Merge in chunk order; float sums depend on order, so this keeps results independent of thread count
+        for (u32 c = 0; c < chunkCount; c++) {
+            const ErosionDeltaList *list = &job.deltas[c];
+            for (u32 d = 0; d < list->count; d++) {
+                heights[list->items[d].cell] += list->items[d].delta;
+            }
+        }
+    }
 
+    for (u32 c = 0; c < chunkCount; c++) {
+        CellData *cells = cm->chunks[c].cellData;
+        for (u32 i = 0; i < cm->cellsPerChunk; i++) {
+            cells[i].height = CLAMP(lroundf(heights[(c * cm->cellsPerChunk) + i]), INT8_MIN, INT8_MAX);
+        }
+        free(job.deltas[c].items);
+    }
+    free(job.deltas);
+    free(heights);
+}
 
+#define SMOOTH_NO_GIVE 0xff
 
+typedef struct {
+    htw_ChunkMap *cm;
+    const bc_HaloChunkMap *halo;
+    s32 minProminance;
+    u8 *giveDirections; // per cell, padded into blocks like the halo's cells: direction of the neighbor the cell gives 1 height to, or SMOOTH_NO_GIVE
+} SmoothJob;
 
+static u8 *smoothGiveBlock(const SmoothJob *job, u32 chunkIndex) {
+    return &job->giveDirections[(size_t)chunkIndex * job->halo->stride * job->halo->stride];
+}
 
+// Pass 1: decide which cells give height and where, reading only the halo
+static void smoothGiveJob(void *ctx, u32 chunkIndex) {
+    SmoothJob *job = ctx;
+    u8 *gives = smoothGiveBlock(job, chunkIndex);
+    u32 stride = job->halo->stride;
+    bc_Stencil s = bc_stencilBegin(job->halo, job->cm, chunkIndex);
+    while (bc_stencilNext(&s)) {
+        s32 height = s.center->height;
+        s32 lowestHeight = height;
+        s32 prominance = 0;
+        u8 give = SMOOTH_NO_GIVE;
+        for (int d = 0; d < HEX_DIRECTION_COUNT; d++) {
+            s32 neighborHeight = bc_stencilNeighbor(&s, d)->height;
+            prominance += height - neighborHeight;
+            if (neighborHeight < lowestHeight) {
+                lowestHeight = neighborHeight;
+                give = d;
+            }
+        }
+        // Cells without a lower neighbor have nowhere to give to
+        gives[(s.x + 1) + ((s.y + 1) * stride)] = prominance >= job->minProminance ? give : SMOOTH_NO_GIVE;
+    }
+}
 
+static u8 smoothGiveAt(const SmoothJob *job, htw_geo_GridCoord pos) {
+    u32 chunkIndex, cellIndex;
+    htw_geo_gridCoordinateToChunkAndCellIndex(job->cm, pos, &chunkIndex, &cellIndex);
+    u32 chunkSize = job->cm->chunkSize;
+    return smoothGiveBlock(job, chunkIndex)[((cellIndex % chunkSize) + 1) + (((cellIndex / chunkSize) + 1) * job->halo->stride)];
+}
 
+// Pass 2: copy the ring of each block from neighboring chunks, the same way bc_refreshHaloChunk does for cells. Only writes this chunk's ring
+static void smoothGiveRingJob(void *ctx, u32 chunkIndex) {
+    SmoothJob *job = ctx;
+    s32 chunkSize = job->cm->chunkSize;
+    u32 stride = job->halo->stride;
+    u8 *gives = smoothGiveBlock(job, chunkIndex);
+    htw_geo_GridCoord root = htw_geo_chunkAndCellToGridCoordinates(job->cm, chunkIndex, 0);
+    for (s32 x = -1; x <= chunkSize; x++) {
+        gives[x + 1] = smoothGiveAt(job, htw_geo_addGridCoords(root, (htw_geo_GridCoord){x, -1}));
+        gives[(x + 1) + ((stride - 1) * stride)] = smoothGiveAt(job, htw_geo_addGridCoords(root, (htw_geo_GridCoord){x, chunkSize}));
+    }
+    for (s32 y = 0; y < chunkSize; y++) {
+        gives[(y + 1) * stride] = smoothGiveAt(job, htw_geo_addGridCoords(root, (htw_geo_GridCoord){-1, y}));
+        gives[(stride - 1) + ((y + 1) * stride)] = smoothGiveAt(job, htw_geo_addGridCoords(root, (htw_geo_GridCoord){chunkSize, y}));
+    }
+}
+
+// Pass 3: every cell takes its own give and any gives from its neighbors, and only writes its own height. Neighbor gives are at the halo's fixed offsets, so no coordinates are wrapped here
+static void smoothApplyJob(void *ctx, u32 chunkIndex) {
+    SmoothJob *job = ctx;
+    const u8 *gives = smoothGiveBlock(job, chunkIndex);
+    u32 stride = job->halo->stride;
+    const s32 *neighborOffsets = job->halo->neighborOffsets;
+    bc_Stencil s = bc_stencilBegin(job->halo, job->cm, chunkIndex);
+    while (bc_stencilNext(&s)) {
+        const u8 *give = &gives[(s.x + 1) + ((s.y + 1) * stride)];
+        s32 height = s.center->height;
+        if (*give != SMOOTH_NO_GIVE) {
+            height--;
+        }
+        for (int d = 0; d < HEX_DIRECTION_COUNT; d++) {
+            // neighbor gives to this cell in the opposite direction
+            if (give[neighborOffsets[d]] == htw_geo_hexDirectionOpposite(d)) {
+                height++;
+            }
+        }
+        s.cell->height = CLAMP(height, INT8_MIN, INT8_MAX);
+    }
+}
 
+void bc_smoothTerrain(htw_ChunkMap *cm, s32 minProminance, u32 iterations, bc_JobPool *pool) {
+    u32 chunkCount = cm->chunkCountX * cm->chunkCountY;
+    bc_HaloChunkMap *halo = bc_createHaloChunkMap(cm);
+    SmoothJob job = {
+        .cm = cm,
+        .halo = halo,
+        .minProminance = minProminance,
+        .giveDirections = malloc((size_t)chunkCount * halo->stride * halo->stride)
+    };
+    for (u32 i = 0; i < iterations; i++) {
+        bc_refreshHaloChunkMap(halo, cm, pool);
+        bc_parallelFor(pool, chunkCount, smoothGiveJob, &job);
+        bc_parallelFor(pool, chunkCount, smoothGiveRingJob, &job);
+        bc_parallelFor(pool, chunkCount, smoothApplyJob, &job);
+    }
+    free(job.giveDirections);
+    bc_destroyHaloChunkMap(halo);
+}
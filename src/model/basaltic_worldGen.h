@@ -3,6 +3,7 @@
 
 #include "htw_core.h"
 #include "htw_geomap.h"
+#include "bc_jobPool.h"
 #include "components/basaltic_components_planes.h"
 
 void bc_elevationBrush(htw_ChunkMap *chunkMap, htw_geo_GridCoord pos, s32 value, u32 radius);
@@ -12,8 +13,63 @@ void bc_seedMountains(htw_ChunkMap *chunkMap, u32 mountainRangeCount, u32 rangeS
 void bc_growMountains(htw_ChunkMap *chunkMap, float slope);
 
 htw_ChunkMap *bc_createTerrain(u32 chunkSize, u32 chunkCountX, u32 chunkCountY);
+/// Free a chunk map from bc_createTerrain, including every chunk's cell data
+void bc_destroyTerrain(htw_ChunkMap *cm);
 
-void bc_generateTerrain(htw_ChunkMap *cm, u32 seed);
+/**
+ * @brief Fill every cell of cm from seeded noise. Each chunk sets every cell field in one pass, and chunks are independent
+ *
+ * @param cm chunk map to overwrite
+ * @param seed noise seed
+ * @param pool if not NULL, spreads chunks across pool threads
+ * @param timings if not NULL, noiseMs is set to the wall time of generation
+ */
+void bc_generateTerrain(htw_ChunkMap *cm, u32 seed, bc_JobPool *pool, WorldGenTimings *timings);
+
+// Optional stages that run after noise when generating a whole plane. Every field is part of the worldgen cache key
+typedef struct {
+    u32 erosionDroplets; // 0 skips erosion
+    u32 erosionSeed; // combined with the world seed
+    u32 smoothIterations; // 0 skips smoothing
+    s32 smoothMinProminance;
+} bc_WorldGenOptions;
+
+/* Worldgen cache
+ * Generated terrain saved to disk, so restarting with the same start args can skip generation. Files are keyed by a hash of everything generation depends on; bump BC_WORLDGEN_VERSION whenever generation changes in a way that gives different cells for the same key
+ */
+
+#define BC_WORLDGEN_VERSION 2
+#define BC_WORLDGEN_CACHE_DIRECTORY "cache"
+
+/// Hash of every parameter generated cells depend on
+u64 bc_worldGenKey(const char *seedString, u32 seed, u32 chunkSize, u32 chunkCountX, u32 chunkCountY, const bc_WorldGenOptions *options);
+
+/// Write path for key into out, inside BC_WORLDGEN_CACHE_DIRECTORY
+void bc_worldGenCachePath(u64 key, char *out, size_t outSize);
+
+/// Fill every chunk of cm from the cache file at path, memory mapped where supported. Returns false without changing cm if the file is missing, or doesn't match key or cm's layout
+bool bc_loadTerrainCache(htw_ChunkMap *cm, const char *path, u64 key);
+
+/// Save every chunk of cm to path, creating BC_WORLDGEN_CACHE_DIRECTORY if needed. Written to a temporary file first, so other processes never load a partial cache. Returns false on any file error
+bool bc_saveTerrainCache(const htw_ChunkMap *cm, const char *path, u64 key);
+
+/* Lazy generation */
+
+/// Start tracking lazy generation for cm, with every chunk empty. Frees the cell storage of every chunk in cm; each chunk gets its own again when it's generated
+bc_LazyChunks *bc_createLazyChunks(htw_ChunkMap *cm, u32 seed);
+/// Free lazy, detaching its shared empty chunk from cm first
+void bc_destroyLazyChunks(htw_ChunkMap *cm, bc_LazyChunks *lazy);
+
+/**
+ * @brief Make every chunk within chunkRadius chunks of the chunk containing center resident, wrapping around map edges. Empty chunks among them and their neighbors are generated first, with the same contents bc_generateTerrain would give them, and their cached biotemperature is updated. Cheap if every chunk is already resident
+ *
+ * @param plane lazily generated plane; does nothing if plane->lazyChunks is NULL
+ * @param center any cell in the center chunk
+ * @param chunkRadius in chunks; 0 makes only the center chunk resident
+ * @param pool if not NULL, spreads generation across pool threads
+ * @return number of chunks generated
+ */
+u32 bc_makeChunksResident(const Plane *plane, htw_geo_GridCoord center, u32 chunkRadius, bc_JobPool *pool);
 
 /* Rivers */
 
@@ -31,7 +87,28 @@ void bc_applyRiverConnection(htw_ChunkMap *cm, const RiverConnection *rc);
 void bc_makeRiverConnection(htw_ChunkMap *cm, htw_geo_GridCoord a, htw_geo_GridCoord b, u8 size);
 void bc_removeRiverConnection(htw_ChunkMap *cm, htw_geo_GridCoord a, htw_geo_GridCoord b);
 
+/* Erosion */
+
+/**
+ * @brief Hydraulic erosion by water droplets. Each droplet starts on a random cell, runs downhill picking up sediment while it's moving fast enough to carry more, and drops it where the slope flattens out or it reaches the sea. Droplets run in batches spread across chunks: every droplet in a batch reads heights from before the batch, and records its height changes in its chunk's own delta list. Lists are merged in chunk order after each batch, so the result only depends on the map, droplets, and seed, never on thread count
+ *
+ * @param cm chunk map to erode
+ * @param droplets total number of droplets
+ * @param seed droplet start positions are hashed from seed and droplet index
+ * @param pool if not NULL, spreads each batch across pool threads
+ */
+void bc_erodeTerrain(htw_ChunkMap *cm, u32 droplets, u32 seed, bc_JobPool *pool);
+
 /* Smoothing */
-void bc_smoothTerrain(htw_ChunkMap *cm, s32 minProminance);
+
+/**
+ * @brief Move height from prominent cells to their lowest neighbor. Every cell whose summed height difference to its neighbors is at least minProminance gives 1 height to its lowest strictly lower neighbor (the first one in direction order on ties). Each iteration reads heights from a halo copy taken before it starts and writes the chunk map, so the result doesn't depend on chunk or cell order, or on thread count
+ *
+ * @param cm chunk map to smooth
+ * @param minProminance threshold for a cell to give height
+ * @param iterations number of passes
+ * @param pool if not NULL, spreads chunks across pool threads
+ */
+void bc_smoothTerrain(htw_ChunkMap *cm, s32 minProminance, u32 iterations, bc_JobPool *pool);
 
 #endif // BASALTIC_WORLDGEN_H_INCLUDED
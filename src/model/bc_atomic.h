@@ -0,0 +1,80 @@
+#ifndef BC_ATOMIC_H_INCLUDED
+#define BC_ATOMIC_H_INCLUDED
+
+#include <stdbool.h>
+#include "htw_core.h"
+
+/* Atomics
+ * Relaxed atomic operations on plain integer fields, e.g. cell data shared between threads, which SDL_atomic_t can't cover because it's always int sized. GCC and Clang use their __atomic builtins, MSVC uses Interlocked intrinsics.
+ * Compare-exchange functions update *expected with the current value on failure, so they can be retried in a loop
+ */
+
+#ifdef _MSC_VER
+#include <intrin.h>
+
+static inline u8 bc_atomicLoadU8(u8 *p) { return *(volatile u8*)p; }
+static inline u16 bc_atomicLoadU16(u16 *p) { return *(volatile u16*)p; }
+static inline u32 bc_atomicLoadU32(u32 *p) { return *(volatile u32*)p; }
+
+static inline bool bc_atomicCompareExchangeU8(u8 *p, u8 *expected, u8 desired) {
+    u8 previous = (u8)_InterlockedCompareExchange8((volatile char*)p, (char)desired, (char)*expected);
+    bool exchanged = previous == *expected;
+    *expected = previous;
+    return exchanged;
+}
+
+static inline bool bc_atomicCompareExchangeU16(u16 *p, u16 *expected, u16 desired) {
+    u16 previous = (u16)_InterlockedCompareExchange16((volatile short*)p, (short)desired, (short)*expected);
+    bool exchanged = previous == *expected;
+    *expected = previous;
+    return exchanged;
+}
+
+static inline bool bc_atomicCompareExchangeU32(u32 *p, u32 *expected, u32 desired) {
+    u32 previous = (u32)_InterlockedCompareExchange((volatile long*)p, (long)desired, (long)*expected);
+    bool exchanged = previous == *expected;
+    *expected = previous;
+    return exchanged;
+}
+
+/// Returns the value after adding
+static inline u32 bc_atomicAddU32(u32 *p, u32 value) {
+    return (u32)_InterlockedExchangeAdd((volatile long*)p, (long)value) + value;
+}
+
+/// Returns the value after adding
+static inline u64 bc_atomicAddU64(u64 *p, u64 value) {
+    return (u64)_InterlockedExchangeAdd64((volatile __int64*)p, (__int64)value) + value;
+}
+
+#else
+
+static inline u8 bc_atomicLoadU8(u8 *p) { return __atomic_load_n(p, __ATOMIC_RELAXED); }
+static inline u16 bc_atomicLoadU16(u16 *p) { return __atomic_load_n(p, __ATOMIC_RELAXED); }
+static inline u32 bc_atomicLoadU32(u32 *p) { return __atomic_load_n(p, __ATOMIC_RELAXED); }
+
+static inline bool bc_atomicCompareExchangeU8(u8 *p, u8 *expected, u8 desired) {
+    return __atomic_compare_exchange_n(p, expected, desired, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+}
+
+static inline bool bc_atomicCompareExchangeU16(u16 *p, u16 *expected, u16 desired) {
+    return __atomic_compare_exchange_n(p, expected, desired, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+}
+
+static inline bool bc_atomicCompareExchangeU32(u32 *p, u32 *expected, u32 desired) {
+    return __atomic_compare_exchange_n(p, expected, desired, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+}
+
+/// Returns the value after adding
+static inline u32 bc_atomicAddU32(u32 *p, u32 value) {
+    return __atomic_add_fetch(p, value, __ATOMIC_RELAXED);
+}
+
+/// Returns the value after adding
+static inline u64 bc_atomicAddU64(u64 *p, u64 value) {
+    return __atomic_add_fetch(p, value, __ATOMIC_RELAXED);
+}
+
+#endif
+
+#endif // BC_ATOMIC_H_INCLUDED
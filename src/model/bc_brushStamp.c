@@ -0,0 +1,51 @@
+#include <stdlib.h>
+#include <math.h>
+#include <SDL2/SDL_atomic.h>
+#include "bc_brushStamp.h"
+
+static SDL_SpinLock buildLock;
+static void *stamps[BC_BRUSH_STAMP_MAX_RADIUS + 1];
+
+static bc_BrushStamp *buildStamp(u32 radius);
+
+const bc_BrushStamp *bc_getBrushStamp(u32 radius) {
+    radius = MIN(radius, BC_BRUSH_STAMP_MAX_RADIUS);
+    bc_BrushStamp *stamp = SDL_AtomicGetPtr(&stamps[radius]);
+    if (stamp != NULL) {
+        return stamp;
+    }
+    SDL_AtomicLock(&buildLock);
+    // Another thread may have built it while this one waited
+    stamp = SDL_AtomicGetPtr(&stamps[radius]);
+    if (stamp == NULL) {
+        stamp = buildStamp(radius);
+        SDL_AtomicSetPtr(&stamps[radius], stamp);
+    }
+    SDL_AtomicUnlock(&buildLock);
+    return stamp;
+}
+
+static bc_BrushStamp *buildStamp(u32 radius) {
+    u32 area = htw_geo_getHexArea(radius);
+    bc_BrushStamp *stamp = malloc(sizeof(bc_BrushStamp));
+    *stamp = (bc_BrushStamp){
+        .radius = radius,
+        .area = area,
+        .offsets = malloc(sizeof(htw_geo_GridCoord) * area),
+        .weights = malloc(sizeof(float) * area),
+    };
+    // Center is at the cartesian origin
+    htw_geo_CubeCoord relative = {0, 0, 0};
+    for (u32 i = 0; i < area; i++) {
+        htw_geo_GridCoord offset = htw_geo_cubeToGridCoord(relative);
+        float x, y;
+        htw_geo_getHexCellPositionSkewed(offset, &x, &y);
+        float dist = sqrtf((x * x) + (y * y));
+        // Radius 0 is a single cell at full strength
+        float curve = radius == 0 ? 1.0 : 1.0 - (dist / radius);
+        stamp->offsets[i] = offset;
+        stamp->weights[i] = curve * curve;
+        htw_geo_getNextHexSpiralCoord(&relative);
+    }
+    return stamp;
+}
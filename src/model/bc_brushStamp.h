@@ -0,0 +1,24 @@
+#ifndef BC_BRUSH_STAMP_H_INCLUDED
+#define BC_BRUSH_STAMP_H_INCLUDED
+
+#include "htw_core.h"
+#include "htw_geomap.h"
+
+/* Brush stamps
+ * Precomputed hex area around a center cell, shared by every brush of the same radius: the grid offset of each cell in hex spiral order (same order as htw_geo_getNextHexSpiralCoord from the center), and a falloff weight from its cartesian distance to the center. Applying a brush is then a walk over a flat table instead of a spiral step, coordinate conversion, and distance per cell.
+ * Stamps are built the first time a radius is requested and live until exit. Safe to request from any thread
+ */
+
+#define BC_BRUSH_STAMP_MAX_RADIUS 128
+
+typedef struct {
+    u32 radius;
+    u32 area; // number of cells, htw_geo_getHexArea(radius)
+    htw_geo_GridCoord *offsets; // add to the brush center with htw_geo_addGridCoords
+    float *weights; // (1 - (distance / radius))^2, 1 at the center
+} bc_BrushStamp;
+
+/// Get the stamp for radius, building it if needed. Radius is clamped to BC_BRUSH_STAMP_MAX_RADIUS
+const bc_BrushStamp *bc_getBrushStamp(u32 radius);
+
+#endif // BC_BRUSH_STAMP_H_INCLUDED
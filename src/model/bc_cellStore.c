@@ -0,0 +1,55 @@
+#include <stdlib.h>
+#include "bc_cellStore.h"
+
+bc_CellStore bc_createCellStore(htw_ChunkMap *chunkMap, bc_CellLayout layout) {
+    bc_CellStore store = {
+        .layout = layout,
+        .chunkMap = chunkMap,
+        .cellsPerChunk = chunkMap->cellsPerChunk,
+        .chunkCount = chunkMap->chunkCountX * chunkMap->chunkCountY,
+    };
+    if (layout == BC_CELL_LAYOUT_SOA) {
+        size_t cellCount = store.chunkCount * store.cellsPerChunk;
+#define ALLOC_COLUMN(type, name) store.name = malloc(sizeof(type) * cellCount);
+        BC_CELL_FIELDS(ALLOC_COLUMN)
+#undef ALLOC_COLUMN
+        bc_cellStoreGather(&store);
+    }
+    return store;
+}
+
+void bc_destroyCellStore(bc_CellStore *store) {
+#define FREE_COLUMN(type, name) free(store->name); store->name = NULL;
+    BC_CELL_FIELDS(FREE_COLUMN)
+#undef FREE_COLUMN
+}
+
+void bc_cellStoreGather(bc_CellStore *store) {
+    if (store->layout != BC_CELL_LAYOUT_SOA) {
+        return;
+    }
+    for (u32 c = 0; c < store->chunkCount; c++) {
+        const CellData *cells = store->chunkMap->chunks[c].cellData;
+        size_t base = c * store->cellsPerChunk;
+        for (u32 i = 0; i < store->cellsPerChunk; i++) {
+#define GATHER_FIELD(type, name) store->name[base + i] = cells[i].name;
+            BC_CELL_FIELDS(GATHER_FIELD)
+#undef GATHER_FIELD
+        }
+    }
+}
+
+void bc_cellStoreScatter(const bc_CellStore *store) {
+    if (store->layout != BC_CELL_LAYOUT_SOA) {
+        return;
+    }
+    for (u32 c = 0; c < store->chunkCount; c++) {
+        CellData *cells = store->chunkMap->chunks[c].cellData;
+        size_t base = c * store->cellsPerChunk;
+        for (u32 i = 0; i < store->cellsPerChunk; i++) {
+#define SCATTER_FIELD(type, name) cells[i].name = store->name[base + i];
+            BC_CELL_FIELDS(SCATTER_FIELD)
+#undef SCATTER_FIELD
+        }
+    }
+}
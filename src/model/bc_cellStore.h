@@ -0,0 +1,72 @@
+#ifndef BC_CELL_STORE_H_INCLUDED
+#define BC_CELL_STORE_H_INCLUDED
+
+#include "htw_core.h"
+#include "htw_geomap.h"
+#include "components/basaltic_components_planes.h"
+
+/* Cell store
+ * Chunk maps keep CellData array-of-structs in each chunk, so a pass that only reads height or waterways still pulls every other field through the cache. A cell store can instead keep one contiguous array per field (struct-of-arrays), indexed by (chunkIndex * cellsPerChunk) + cellIndex so each chunk's values of a field stay together.
+ * Passes written against the bc_cellGet_<field>/bc_cellSet_<field> accessors work on either layout. Planes always keep their cells in the chunk map, and no simulation pass runs on a store: an SOA store is a side copy, gathered from and scattered back to the chunk map, and the accessors branch on layout for every field. It exists to measure what each layout costs, with `basaltic_headless -b`, before committing any pass to one
+ */
+
+typedef enum {
+    BC_CELL_LAYOUT_AOS, // accessors read and write the chunk map directly
+    BC_CELL_LAYOUT_SOA,
+} bc_CellLayout;
+
+// X-macro over every CellData field: X(type, name)
+#define BC_CELL_FIELDS(X) \
+    X(s8, height) \
+    X(u8, visibility) \
+    X(CellGeology, geology) \
+    X(u16, tracks) \
+    X(s16, groundwater) \
+    X(u16, surfacewater) \
+    X(u16, humidityPreference) \
+    X(CellWaterways, waterways) \
+    X(u32, understory) \
+    X(u32, canopy)
+
+#define BC_CELL_STORE_COLUMN(type, name) type *name;
+
+typedef struct {
+    bc_CellLayout layout;
+    htw_ChunkMap *chunkMap;
+    u32 cellsPerChunk;
+    u32 chunkCount;
+    // One array of chunkCount * cellsPerChunk values per field. NULL in AOS layout
+    BC_CELL_FIELDS(BC_CELL_STORE_COLUMN)
+} bc_CellStore;
+
+#undef BC_CELL_STORE_COLUMN
+
+/// Create a store for chunkMap's cells. In SOA layout, allocates a copy of every field and gathers current values from chunkMap
+bc_CellStore bc_createCellStore(htw_ChunkMap *chunkMap, bc_CellLayout layout);
+void bc_destroyCellStore(bc_CellStore *store);
+
+/// SOA only: copy every cell from the chunk map into the field arrays
+void bc_cellStoreGather(bc_CellStore *store);
+/// SOA only: copy the field arrays back into the chunk map's CellData
+void bc_cellStoreScatter(const bc_CellStore *store);
+
+#define BC_CELL_STORE_ACCESSORS(type, name) \
+static inline type bc_cellGet_##name(const bc_CellStore *store, u32 chunkIndex, u32 cellIndex) { \
+    if (store->layout == BC_CELL_LAYOUT_SOA) { \
+        return store->name[(chunkIndex * store->cellsPerChunk) + cellIndex]; \
+    } \
+    return ((CellData*)store->chunkMap->chunks[chunkIndex].cellData)[cellIndex].name; \
+} \
+static inline void bc_cellSet_##name(bc_CellStore *store, u32 chunkIndex, u32 cellIndex, type value) { \
+    if (store->layout == BC_CELL_LAYOUT_SOA) { \
+        store->name[(chunkIndex * store->cellsPerChunk) + cellIndex] = value; \
+    } else { \
+        ((CellData*)store->chunkMap->chunks[chunkIndex].cellData)[cellIndex].name = value; \
+    } \
+}
+
+BC_CELL_FIELDS(BC_CELL_STORE_ACCESSORS)
+
+#undef BC_CELL_STORE_ACCESSORS
+
+#endif // BC_CELL_STORE_H_INCLUDED
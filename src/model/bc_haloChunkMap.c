@@ -0,0 +1,66 @@
+#include <stdlib.h>
+#include <string.h>
+#include "bc_haloChunkMap.h"
+
+typedef struct {
+    bc_HaloChunkMap *halo;
+    const htw_ChunkMap *chunkMap;
+} RefreshJob;
+
+static void refreshJob(void *ctx, u32 chunkIndex);
+
+bc_HaloChunkMap *bc_createHaloChunkMap(const htw_ChunkMap *chunkMap) {
+    bc_HaloChunkMap *halo = malloc(sizeof(bc_HaloChunkMap));
+    halo->chunkSize = chunkMap->chunkSize;
+    halo->chunkCount = chunkMap->chunkCountX * chunkMap->chunkCountY;
+    halo->stride = chunkMap->chunkSize + 2;
+    for (int d = 0; d < HEX_DIRECTION_COUNT; d++) {
+        htw_geo_GridCoord offset = htw_geo_hexGridDirections[d];
+        halo->neighborOffsets[d] = offset.x + (offset.y * (s32)halo->stride);
+    }
+    halo->cells = malloc((size_t)halo->chunkCount * halo->stride * halo->stride * sizeof(CellData));
+    return halo;
+}
+
+void bc_destroyHaloChunkMap(bc_HaloChunkMap *halo) {
+    if (halo == NULL) {
+        return;
+    }
+    free(halo->cells);
+    free(halo);
+}
+
+void bc_refreshHaloChunk(bc_HaloChunkMap *halo, const htw_ChunkMap *chunkMap, u32 chunkIndex) {
+    u32 chunkSize = halo->chunkSize;
+    u32 stride = halo->stride;
+    CellData *block = &halo->cells[(size_t)chunkIndex * stride * stride];
+    const CellData *chunkCells = chunkMap->chunks[chunkIndex].cellData;
+    htw_geo_GridCoord root = htw_geo_chunkAndCellToGridCoordinates(chunkMap, chunkIndex, 0);
+
+    // Interior rows are contiguous in both layouts
+    for (u32 y = 0; y < chunkSize; y++) {
+        memcpy(&block[1 + ((y + 1) * stride)], &chunkCells[y * chunkSize], chunkSize * sizeof(CellData));
+    }
+    // Ring comes from neighboring chunks; htw_geo_getCell handles wrapping
+    for (s32 x = -1; x <= (s32)chunkSize; x++) {
+        block[x + 1] = *(CellData*)htw_geo_getCell(chunkMap, htw_geo_addGridCoords(root, (htw_geo_GridCoord){x, -1}));
+        block[(x + 1) + ((stride - 1) * stride)] = *(CellData*)htw_geo_getCell(chunkMap, htw_geo_addGridCoords(root, (htw_geo_GridCoord){x, chunkSize}));
+    }
+    for (s32 y = 0; y < (s32)chunkSize; y++) {
+        block[(y + 1) * stride] = *(CellData*)htw_geo_getCell(chunkMap, htw_geo_addGridCoords(root, (htw_geo_GridCoord){-1, y}));
+        block[(stride - 1) + ((y + 1) * stride)] = *(CellData*)htw_geo_getCell(chunkMap, htw_geo_addGridCoords(root, (htw_geo_GridCoord){chunkSize, y}));
+    }
+}
+
+void bc_refreshHaloChunkMap(bc_HaloChunkMap *halo, const htw_ChunkMap *chunkMap, bc_JobPool *pool) {
+    RefreshJob job = {
+        .halo = halo,
+        .chunkMap = chunkMap
+    };
+    bc_parallelFor(pool, halo->chunkCount, refreshJob, &job);
+}
+
+static void refreshJob(void *ctx, u32 chunkIndex) {
+    RefreshJob *job = ctx;
+    bc_refreshHaloChunk(job->halo, job->chunkMap, chunkIndex);
+}
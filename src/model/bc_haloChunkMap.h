@@ -0,0 +1,84 @@
+#ifndef BC_HALO_CHUNK_MAP_H_INCLUDED
+#define BC_HALO_CHUNK_MAP_H_INCLUDED
+
+#include "htw_core.h"
+#include "htw_geomap.h"
+#include "bc_jobPool.h"
+#include "components/basaltic_components_planes.h"
+
+/* Halo chunk map
+ * Read-only copy of a chunk map's CellData where every chunk is padded with a 1 cell ring (halo) copied from its neighboring chunks, wrapping around map edges. Any neighbor of a cell in the chunk is then at a fixed pointer offset from that cell, so stencil passes don't need to wrap coordinates or look up chunk and cell indices for every neighbor.
+ * The copy is only as fresh as the last refresh. Stencil passes that read neighbors from the halo and write to the chunk map also get the previous state of every neighbor, regardless of which cells were already updated, which makes them independent of chunk and cell order
+ */
+
+typedef struct {
+    u32 chunkSize;
+    u32 chunkCount;
+    u32 stride; // chunkSize + 2
+    s32 neighborOffsets[HEX_DIRECTION_COUNT]; // from any padded cell to its neighbor in each direction
+    CellData *cells; // chunkCount blocks of stride * stride cells
+} bc_HaloChunkMap;
+
+/// Allocate a halo map matching the layout of chunkMap. Contents are undefined until refreshed
+bc_HaloChunkMap *bc_createHaloChunkMap(const htw_ChunkMap *chunkMap);
+void bc_destroyHaloChunkMap(bc_HaloChunkMap *halo);
+
+/// Copy one chunk and its ring of neighbors from chunkMap. Only writes that chunk's block, so chunks can be refreshed in parallel
+void bc_refreshHaloChunk(bc_HaloChunkMap *halo, const htw_ChunkMap *chunkMap, u32 chunkIndex);
+/// Refresh every chunk, spread across pool if not NULL
+void bc_refreshHaloChunkMap(bc_HaloChunkMap *halo, const htw_ChunkMap *chunkMap, bc_JobPool *pool);
+
+/* Stencil iteration
+ * Visits every cell in one chunk in cell index order, e.g.
+ *
+ * bc_Stencil s = bc_stencilBegin(halo, chunkMap, chunkIndex);
+ * while (bc_stencilNext(&s)) {
+ *     const CellData *east = bc_stencilNeighbor(&s, HEX_DIRECTION_EAST);
+ *     s.cell->height = ...
+ * }
+ */
+
+typedef struct {
+    const bc_HaloChunkMap *halo;
+    CellData *chunkCells;
+    u32 chunkIndex;
+    u32 cellIndex; // in the chunk map's cellData
+    s32 x, y; // position in chunk
+    CellData *cell; // cell in chunk map, safe to write
+    const CellData *center; // halo copy of cell
+} bc_Stencil;
+
+static inline bc_Stencil bc_stencilBegin(const bc_HaloChunkMap *halo, htw_ChunkMap *chunkMap, u32 chunkIndex) {
+    return (bc_Stencil){
+        .halo = halo,
+        .chunkCells = chunkMap->chunks[chunkIndex].cellData,
+        .chunkIndex = chunkIndex,
+        .cellIndex = 0,
+        .x = -1,
+        .y = 0,
+    };
+}
+
+/// Advance to the next cell in the chunk. Returns false after the last cell
+static inline bool bc_stencilNext(bc_Stencil *s) {
+    u32 chunkSize = s->halo->chunkSize;
+    if (++s->x == chunkSize) {
+        s->x = 0;
+        s->y++;
+    }
+    if (s->y == chunkSize) {
+        return false;
+    }
+    s->cellIndex = s->x + (s->y * chunkSize);
+    s->cell = &s->chunkCells[s->cellIndex];
+    const CellData *block = &s->halo->cells[(size_t)s->chunkIndex * s->halo->stride * s->halo->stride];
+    s->center = &block[(s->x + 1) + ((s->y + 1) * s->halo->stride)];
+    return true;
+}
+
+/// Halo copy of the neighbor in direction
+static inline const CellData *bc_stencilNeighbor(const bc_Stencil *s, HexDirection direction) {
+    return s->center + s->halo->neighborOffsets[direction];
+}
+
+#endif // BC_HALO_CHUNK_MAP_H_INCLUDED
@@ -0,0 +1,127 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <SDL2/SDL.h>
+#include "bc_jobPool.h"
+
+struct bc_JobPool {
+    u32 threadCount;
+    SDL_Thread **threads;
+
+    SDL_mutex *mutex;
+    SDL_cond *start; // signaled when a new job is posted, or on shutdown
+    SDL_cond *done; // signaled when the last helper finishes a job
+    u64 generation; // incremented for every job, so helpers can tell a new job from a spurious wakeup
+    u32 busyThreads;
+    bool shouldStop;
+
+    // Current job; only changed while no helper is busy
+    bc_JobFunction fn;
+    void *ctx;
+    u32 count;
+    SDL_atomic_t nextIndex;
+};
+
+static int jobThread(void *data);
+static void runJobs(bc_JobPool *pool);
+
+bc_JobPool *bc_createJobPool(u32 threadCount) {
+    bc_JobPool *pool = calloc(1, sizeof(bc_JobPool));
+    pool->mutex = SDL_CreateMutex();
+    pool->start = SDL_CreateCond();
+    pool->done = SDL_CreateCond();
+
+    pool->threads = calloc(threadCount, sizeof(pool->threads[0]));
+    for (int i = 0; i < threadCount; i++) {
+        char name[32];
+        snprintf(name, sizeof(name), "model jobs %i", i);
+        pool->threads[i] = SDL_CreateThread(jobThread, name, pool);
+        if (pool->threads[i] == NULL) {
+            fprintf(stderr, "Could not create job thread: %s\n", SDL_GetError());
+            break;
+        }
+        pool->threadCount++;
+    }
+    return pool;
+}
+
+void bc_destroyJobPool(bc_JobPool *pool) {
+    SDL_LockMutex(pool->mutex);
+    pool->shouldStop = true;
+    SDL_CondBroadcast(pool->start);
+    SDL_UnlockMutex(pool->mutex);
+
+    for (int i = 0; i < pool->threadCount; i++) {
+        SDL_WaitThread(pool->threads[i], NULL);
+    }
+    free(pool->threads);
+    SDL_DestroyCond(pool->done);
+    SDL_DestroyCond(pool->start);
+    SDL_DestroyMutex(pool->mutex);
+    free(pool);
+}
+
+u32 bc_jobPoolConcurrency(const bc_JobPool *pool) {
+    return pool == NULL ? 1 : pool->threadCount + 1;
+}
+
+void bc_parallelFor(bc_JobPool *pool, u32 count, bc_JobFunction fn, void *ctx) {
+    if (pool == NULL || pool->threadCount == 0 || count <= 1) {
+        for (u32 i = 0; i < count; i++) {
+            fn(ctx, i);
+        }
+        return;
+    }
+
+    SDL_LockMutex(pool->mutex);
+    pool->fn = fn;
+    pool->ctx = ctx;
+    pool->count = count;
+    SDL_AtomicSet(&pool->nextIndex, 0);
+    pool->busyThreads = pool->threadCount;
+    pool->generation++;
+    SDL_CondBroadcast(pool->start);
+    SDL_UnlockMutex(pool->mutex);
+
+    runJobs(pool);
+
+    SDL_LockMutex(pool->mutex);
+    while (pool->busyThreads > 0) {
+        SDL_CondWait(pool->done, pool->mutex);
+    }
+    SDL_UnlockMutex(pool->mutex);
+}
+
+static int jobThread(void *data) {
+    bc_JobPool *pool = data;
+    u64 seenGeneration = 0;
+
+    SDL_LockMutex(pool->mutex);
+    while (true) {
+        while (pool->generation == seenGeneration && !pool->shouldStop) {
+            SDL_CondWait(pool->start, pool->mutex);
+        }
+        if (pool->shouldStop) {
+            break;
+        }
+        seenGeneration = pool->generation;
+        SDL_UnlockMutex(pool->mutex);
+
+        runJobs(pool);
+
+        SDL_LockMutex(pool->mutex);
+        pool->busyThreads--;
+        if (pool->busyThreads == 0) {
+            SDL_CondSignal(pool->done);
+        }
+    }
+    SDL_UnlockMutex(pool->mutex);
+    return 0;
+}
+
+// Take job indices until there are none left
+static void runJobs(bc_JobPool *pool) {
+    u32 index;
+    while ((index = SDL_AtomicAdd(&pool->nextIndex, 1)) < pool->count) {
+        pool->fn(pool->ctx, index);
+    }
+}
@@ -0,0 +1,39 @@
+#ifndef BC_JOB_POOL_H_INCLUDED
+#define BC_JOB_POOL_H_INCLUDED
+
+#include "htw_core.h"
+
+/* Job pool
+ * Fixed set of helper threads for splitting one system's work, e.g. over the chunks of a single plane, which flecs can't split across its own worker threads. Jobs are picked up in any order, so results are only deterministic if each job index writes to memory no other index reads or writes
+ */
+
+typedef struct bc_JobPool bc_JobPool;
+
+/// Called once for every index in [0, count)
+typedef void (*bc_JobFunction)(void *ctx, u32 index);
+
+/**
+ * @brief Start a job pool
+ *
+ * @param threadCount number of helper threads. The thread calling bc_parallelFor always works too, so 0 runs every job on the calling thread
+ * @return new job pool
+ */
+bc_JobPool *bc_createJobPool(u32 threadCount);
+
+/// Stops and joins all helper threads. Must not be called during bc_parallelFor
+void bc_destroyJobPool(bc_JobPool *pool);
+
+/// Number of threads that work on jobs, including the caller of bc_parallelFor
+u32 bc_jobPoolConcurrency(const bc_JobPool *pool);
+
+/**
+ * @brief Run fn for every index in [0, count) across all pool threads, and wait for all of them to finish. Not reentrant; only one thread may call this at a time per pool
+ *
+ * @param pool if NULL, runs every job on the calling thread
+ * @param count number of jobs
+ * @param fn job function
+ * @param ctx passed through to fn
+ */
+void bc_parallelFor(bc_JobPool *pool, u32 count, bc_JobFunction fn, void *ctx);
+
+#endif // BC_JOB_POOL_H_INCLUDED
@@ -0,0 +1,216 @@
+#include <stdlib.h>
+#include <string.h>
+#include "bc_modelSnapshot.h"
+
+// Set on the shared index when it refers to a snapshot the reader hasn't taken yet
+#define SNAPSHOT_FRESH_BIT 0x4
+#define SNAPSHOT_INDEX_MASK 0x3
+
+struct bc_ModelSnapshotBuffer {
+    bc_ModelSnapshot snapshots[BC_SNAPSHOT_BUFFER_COUNT];
+    // Index of the most recently published snapshot, ORed with SNAPSHOT_FRESH_BIT until the reader takes it
+    SDL_atomic_t shared;
+    s32 writeIndex; // only touched by the model thread
+    s32 readIndex; // only touched by the view thread
+    ecs_query_t *planeQuery;
+    ecs_query_t *entityQuery;
+};
+
+static void copyPlaneCells(Plane *dst, const Plane *src);
+static void freePlaneCells(Plane *plane);
+static int compareSnapshotEntities(const void *a, const void *b);
+
+bc_ModelSnapshotBuffer *bc_createModelSnapshotBuffer(ecs_world_t *world) {
+    bc_ModelSnapshotBuffer *sb = calloc(1, sizeof(bc_ModelSnapshotBuffer));
+    sb->writeIndex = 0;
+    sb->readIndex = 1;
+    SDL_AtomicSet(&sb->shared, 2);
+
+    sb->planeQuery = ecs_query(world, {
+        .filter.terms = {
+            {.id = ecs_id(Plane), .inout = EcsIn},
+            {.id = ecs_id(Climate), .inout = EcsIn, .oper = EcsOptional}
+        }
+    });
+    sb->entityQuery = ecs_query(world, {
+        .filter.terms = {
+            {.id = ecs_id(Position), .inout = EcsIn},
+            {.id = ecs_id(Plane), .inout = EcsInOutNone, .src = {.flags = EcsUp, .trav = IsIn}}
+        }
+    });
+
+    return sb;
+}
+
+void bc_destroyModelSnapshotBuffer(bc_ModelSnapshotBuffer *sb) {
+    for (int i = 0; i < BC_SNAPSHOT_BUFFER_COUNT; i++) {
+        bc_ModelSnapshot *s = &sb->snapshots[i];
+        for (int p = 0; p < s->planeCapacity; p++) {
+            freePlaneCells(&s->planes[p].plane);
+            plane_FreeBiotemperature(s->planes[p].plane.biotemperature);
+        }
+        free(s->planes);
+        free(s->entities);
+    }
+    ecs_query_fini(sb->planeQuery);
+    ecs_query_fini(sb->entityQuery);
+    free(sb);
+}
+
+void bc_publishModelSnapshot(bc_ModelSnapshotBuffer *sb, ecs_world_t *world, u64 step) {
+    bc_ModelSnapshot *s = &sb->snapshots[sb->writeIndex];
+    s->step = step;
+
+    // Planes
+    s->planeCount = 0;
+    ecs_iter_t pit = ecs_query_iter(world, sb->planeQuery);
+    while (ecs_query_next(&pit)) {
+        Plane *planes = ecs_field(&pit, Plane, 1);
+        Climate *climates = ecs_field_is_set(&pit, 2) ? ecs_field(&pit, Climate, 2) : NULL;
+        for (int i = 0; i < pit.count; i++) {
+            if (s->planeCount == s->planeCapacity) {
+                u32 newCapacity = MAX(4, s->planeCapacity * 2);
+                s->planes = realloc(s->planes, newCapacity * sizeof(s->planes[0]));
+                memset(&s->planes[s->planeCapacity], 0, (newCapacity - s->planeCapacity) * sizeof(s->planes[0]));
+                s->planeCapacity = newCapacity;
+            }
+            bc_SnapshotPlane *sp = &s->planes[s->planeCount++];
+            sp->entity = pit.entities[i];
+            copyPlaneCells(&sp->plane, &planes[i]);
+            plane_CopyBiotemperature(&sp->plane.biotemperature, planes[i].biotemperature);
+            sp->hasClimate = climates != NULL;
+            if (climates != NULL) {
+                sp->climate = climates[i];
+            }
+        }
+    }
+
+    // Positioned entities
+    s->entityCount = 0;
+    ecs_iter_t eit = ecs_query_iter(world, sb->entityQuery);
+    while (ecs_query_next(&eit)) {
+        Position *positions = ecs_field(&eit, Position, 1);
+        ecs_entity_t plane = ecs_field_src(&eit, 2);
+        if (s->entityCount + eit.count > s->entityCapacity) {
+            s->entityCapacity = MAX(s->entityCapacity * 2, s->entityCount + eit.count);
+            s->entities = realloc(s->entities, s->entityCapacity * sizeof(s->entities[0]));
+        }
+        for (int i = 0; i < eit.count; i++) {
+            s->entities[s->entityCount++] = (bc_SnapshotEntity){
+                .entity = eit.entities[i],
+                .plane = plane,
+                .position = positions[i]
+            };
+        }
+    }
+    qsort(s->entities, s->entityCount, sizeof(s->entities[0]), compareSnapshotEntities);
+
+    // Swap the finished snapshot with the shared one. Release ordering makes all writes above visible before the index is
+    SDL_MemoryBarrierRelease();
+    s32 previous = SDL_AtomicSet(&sb->shared, sb->writeIndex | SNAPSHOT_FRESH_BIT);
+    sb->writeIndex = previous & SNAPSHOT_INDEX_MASK;
+}
+
+bool bc_isModelSnapshotPending(bc_ModelSnapshotBuffer *sb) {
+    return (SDL_AtomicGet(&sb->shared) & SNAPSHOT_FRESH_BIT) != 0;
+}
+
+const bc_ModelSnapshot *bc_acquireModelSnapshot(bc_ModelSnapshotBuffer *sb, bool *isNew) {
+    bool fresh = bc_isModelSnapshotPending(sb);
+    if (fresh) {
+        s32 latest = SDL_AtomicSet(&sb->shared, sb->readIndex);
+        SDL_MemoryBarrierAcquire();
+        sb->readIndex = latest & SNAPSHOT_INDEX_MASK;
+    }
+    if (isNew != NULL) {
+        *isNew = fresh;
+    }
+    return &sb->snapshots[sb->readIndex];
+}
+
+const bc_SnapshotPlane *bc_findSnapshotPlane(const bc_ModelSnapshot *snapshot, ecs_entity_t plane) {
+    for (int i = 0; i < snapshot->planeCount; i++) {
+        if (snapshot->planes[i].entity == plane) {
+            return &snapshot->planes[i];
+        }
+    }
+    return NULL;
+}
+
+const bc_SnapshotEntity *bc_findSnapshotEntity(const bc_ModelSnapshot *snapshot, ecs_entity_t entity) {
+    bc_SnapshotEntity key = {.entity = entity};
+    return bsearch(&key, snapshot->entities, snapshot->entityCount, sizeof(snapshot->entities[0]), compareSnapshotEntities);
+}
+
+// Copies the chunk map and lazy generation state of src into dst, (re)allocating as needed. Only generated chunks are copied; chunks lazy generation hasn't reached yet all point to the copy's own zeroed emptyCells, same as in the model. Other chunk map members are shallow copied, so the copy must be freed with freePlaneCells
+static void copyPlaneCells(Plane *dst, const Plane *src) {
+    htw_ChunkMap *cm = dst->chunkMap;
+    const htw_ChunkMap *srcCm = src->chunkMap;
+    u32 chunkCount = srcCm->chunkCountX * srcCm->chunkCountY;
+    size_t chunkDataSize = srcCm->cellsPerChunk * sizeof(CellData);
+    if (cm == NULL || cm->chunkSize != srcCm->chunkSize || cm->chunkCountX != srcCm->chunkCountX || cm->chunkCountY != srcCm->chunkCountY ||
+        (dst->lazyChunks == NULL) != (src->lazyChunks == NULL)) {
+        freePlaneCells(dst);
+        cm = malloc(sizeof(htw_ChunkMap));
+        *cm = *srcCm;
+        cm->chunks = malloc(chunkCount * sizeof(cm->chunks[0]));
+        memcpy(cm->chunks, srcCm->chunks, chunkCount * sizeof(cm->chunks[0]));
+        // Each chunk gets its own storage the first time it's copied
+        for (int c = 0; c < chunkCount; c++) {
+            cm->chunks[c].cellData = NULL;
+        }
+        dst->chunkMap = cm;
+        if (src->lazyChunks != NULL) {
+            dst->lazyChunks = malloc(sizeof(bc_LazyChunks));
+            dst->lazyChunks->states = malloc(chunkCount * sizeof(u8));
+            dst->lazyChunks->emptyCells = calloc(srcCm->cellsPerChunk, sizeof(CellData));
+        }
+    }
+
+    bc_LazyChunks *lazy = dst->lazyChunks;
+    if (lazy != NULL) {
+        lazy->seed = src->lazyChunks->seed;
+        lazy->chunkCount = src->lazyChunks->chunkCount;
+        lazy->residentCount = src->lazyChunks->residentCount;
+        memcpy(lazy->states, src->lazyChunks->states, chunkCount * sizeof(u8));
+    }
+    for (int c = 0; c < chunkCount; c++) {
+        if (!plane_IsChunkGenerated(src, c)) {
+            cm->chunks[c].cellData = lazy->emptyCells;
+            continue;
+        }
+        // Chunks are never emptied again once generated, so this only allocates the first time
+        if (cm->chunks[c].cellData == NULL || (lazy != NULL && cm->chunks[c].cellData == lazy->emptyCells)) {
+            cm->chunks[c].cellData = malloc(chunkDataSize);
+        }
+        memcpy(cm->chunks[c].cellData, srcCm->chunks[c].cellData, chunkDataSize);
+    }
+}
+
+static void freePlaneCells(Plane *plane) {
+    htw_ChunkMap *cm = plane->chunkMap;
+    bc_LazyChunks *lazy = plane->lazyChunks;
+    if (cm != NULL) {
+        u32 chunkCount = cm->chunkCountX * cm->chunkCountY;
+        for (int c = 0; c < chunkCount; c++) {
+            if (lazy == NULL || cm->chunks[c].cellData != lazy->emptyCells) {
+                free(cm->chunks[c].cellData);
+            }
+        }
+        free(cm->chunks);
+        free(cm);
+    }
+    if (lazy != NULL) {
+        free(lazy->states);
+        free(lazy->emptyCells);
+        free(lazy);
+    }
+    plane->chunkMap = NULL;
+    plane->lazyChunks = NULL;
+}
+
+static int compareSnapshotEntities(const void *a, const void *b) {
+    ecs_entity_t ea = ((const bc_SnapshotEntity*)a)->entity;
+    ecs_entity_t eb = ((const bc_SnapshotEntity*)b)->entity;
+    return (ea > eb) - (ea < eb);
+}
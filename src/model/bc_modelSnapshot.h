@@ -0,0 +1,82 @@
+#ifndef BC_MODEL_SNAPSHOT_H_INCLUDED
+#define BC_MODEL_SNAPSHOT_H_INCLUDED
+
+#include <stdbool.h>
+#include <SDL2/SDL_atomic.h>
+#include "htw_core.h"
+#include "htw_geomap.h"
+#include "flecs.h"
+#include "basaltic_components.h"
+
+/* Model snapshots
+ * Read-only copies of the model state that renderers need, published by the model thread after a step. The view can read the latest snapshot at any time without taking the model mutex, so rendering never waits for a step batch, and the model never waits for rendering.
+ *
+ * Uses triple buffering: the model owns one buffer to write into, the view owns one buffer to read from, and the third is the most recently published snapshot. Ownership changes hands with a single atomic exchange of buffer indices.
+ */
+
+#define BC_SNAPSHOT_BUFFER_COUNT 3
+
+typedef struct {
+    ecs_entity_t entity; // in model world
+    Plane plane; // chunkMap, lazyChunks and biotemperature are copies owned by the snapshot, with the same layout as the model's. Chunks that aren't generated yet aren't copied; they share lazyChunks->emptyCells
+    Climate climate;
+    bool hasClimate;
+} bc_SnapshotPlane;
+
+typedef struct {
+    ecs_entity_t entity; // in model world
+    ecs_entity_t plane; // in model world
+    Position position;
+} bc_SnapshotEntity;
+
+typedef struct {
+    u64 step; // model step this snapshot was taken after
+    u32 planeCount;
+    u32 planeCapacity;
+    bc_SnapshotPlane *planes;
+    // All entities with a Position on a Plane, sorted by entity id
+    u32 entityCount;
+    u32 entityCapacity;
+    bc_SnapshotEntity *entities;
+} bc_ModelSnapshot;
+
+typedef struct bc_ModelSnapshotBuffer bc_ModelSnapshotBuffer;
+
+/**
+ * @brief Create snapshot buffers for a model world. Must be called from the thread that owns world
+ *
+ * @param world model world that snapshots will be taken from
+ * @return new snapshot buffer, with an empty snapshot (step 0) ready for reading
+ */
+bc_ModelSnapshotBuffer *bc_createModelSnapshotBuffer(ecs_world_t *world);
+
+/// Frees all snapshots. Caller must ensure that neither the model nor view are still using the buffer
+void bc_destroyModelSnapshotBuffer(bc_ModelSnapshotBuffer *sb);
+
+/**
+ * @brief Copy current model state into the model-owned snapshot, then make it the latest snapshot. Never blocks. Only call from the model thread.
+ *
+ * @param sb
+ * @param world model world, must not be in the middle of a progress call
+ * @param step current model step
+ */
+void bc_publishModelSnapshot(bc_ModelSnapshotBuffer *sb, ecs_world_t *world, u64 step);
+
+/// True if the most recently published snapshot hasn't been acquired by the view yet. Useful to avoid copying the model every step when the view can't keep up
+bool bc_isModelSnapshotPending(bc_ModelSnapshotBuffer *sb);
+
+/**
+ * @brief Get the most recently published snapshot. Never blocks. Only call from the view thread. The returned snapshot stays valid and unchanged until the next call to this function
+ *
+ * @param sb
+ * @param isNew if not NULL, set to true if the snapshot is different from the one returned by the previous call
+ * @return latest snapshot
+ */
+const bc_ModelSnapshot *bc_acquireModelSnapshot(bc_ModelSnapshotBuffer *sb, bool *isNew);
+
+/// Returns NULL if plane isn't in the snapshot
+const bc_SnapshotPlane *bc_findSnapshotPlane(const bc_ModelSnapshot *snapshot, ecs_entity_t plane);
+/// Returns NULL if entity isn't in the snapshot. Binary search, O(log n)
+const bc_SnapshotEntity *bc_findSnapshotEntity(const bc_ModelSnapshot *snapshot, ecs_entity_t entity);
+
+#endif // BC_MODEL_SNAPSHOT_H_INCLUDED
@@ -0,0 +1,159 @@
+#include <string.h>
+#include <SDL2/SDL_timer.h>
+#include "bc_modelTiming.h"
+#include "bc_atomic.h"
+#include "basaltic_phases.h"
+
+typedef struct {
+    bc_ModelTimingHistory *history;
+    u32 systemIndex;
+} SystemTimer;
+
+const char *bc_modelPhaseNames[BC_MODEL_PHASE_COUNT] = {
+    [BC_MODEL_PHASE_APPLY_COMMANDS] = "ApplyCommands",
+    [BC_MODEL_PHASE_PREP] = "Prep",
+    [BC_MODEL_PHASE_EXECUTION] = "Execution",
+    [BC_MODEL_PHASE_RESOLUTION] = "Resolution",
+    [BC_MODEL_PHASE_CLEANUP] = "Cleanup",
+    [BC_MODEL_PHASE_ADVANCE_STEP] = "AdvanceStep",
+    [BC_MODEL_PHASE_PLANNING] = "Planning",
+    [BC_MODEL_PHASE_OTHER] = "Other",
+};
+
+void bc_modelTimingSystemAverages(const bc_ModelTimingHistory *history, float *averagesMs, float *maxesMs, u32 *order) {
+    u32 entryCount = bc_modelTimingEntryCount(history);
+    double msPerTick = 1000.0 / history->performanceFrequency;
+    for (int s = 0; s < history->systemCount; s++) {
+        u64 sum = 0;
+        u64 max = 0;
+        for (int i = 0; i < entryCount; i++) {
+            u64 t = history->systemTimes[i][s];
+            sum += t;
+            max = MAX(max, t);
+        }
+        averagesMs[s] = entryCount == 0 ? 0.0 : (sum * msPerTick) / entryCount;
+        if (maxesMs != NULL) {
+            maxesMs[s] = max * msPerTick;
+        }
+        // Insertion sort, there are only a few dozen systems
+        int o = s;
+        for (; o > 0 && averagesMs[order[o - 1]] < averagesMs[s]; o--) {
+            order[o] = order[o - 1];
+        }
+        order[o] = s;
+    }
+}
+
+static bool isBuiltin(ecs_world_t *world, ecs_entity_t e);
+static bc_ModelPhase getSystemPhase(ecs_world_t *world, ecs_entity_t system);
+static void timedSystemRun(ecs_iter_t *it);
+
+void bc_instrumentModelSystems(ecs_world_t *world, bc_ModelTimingHistory *history) {
+    memset(history, 0, sizeof(*history));
+    history->performanceFrequency = SDL_GetPerformanceFrequency();
+
+    // Collect first, because updating a system while iterating the filter would modify tables in use
+    ecs_entity_t systems[BC_MODEL_TIMING_MAX_SYSTEMS];
+    u32 systemCount = 0;
+    ecs_filter_t *filter = ecs_filter(world, {
+        .terms = {{.id = EcsSystem}}
+    });
+    ecs_iter_t it = ecs_filter_iter(world, filter);
+    while (ecs_filter_next(&it)) {
+        for (int i = 0; i < it.count; i++) {
+            ecs_entity_t system = it.entities[i];
+            // Skip builtin systems like timers and pipeline management
+            if (isBuiltin(world, system)) {
+                continue;
+            }
+            if (systemCount == BC_MODEL_TIMING_MAX_SYSTEMS) {
+                ecs_warn("More than %i model systems, the rest won't be timed", BC_MODEL_TIMING_MAX_SYSTEMS);
+                break;
+            }
+            systems[systemCount++] = system;
+        }
+    }
+    ecs_filter_fini(filter);
+
+    for (int i = 0; i < systemCount; i++) {
+        ecs_entity_t system = systems[i];
+        const char *name = ecs_get_name(world, system);
+        strncpy(history->systemNames[i], name == NULL ? "(unnamed)" : name, BC_MODEL_TIMING_NAME_LENGTH - 1);
+        history->systemPhases[i] = getSystemPhase(world, system);
+
+        SystemTimer *timer = ecs_os_malloc_t(SystemTimer);
+        *timer = (SystemTimer){.history = history, .systemIndex = i};
+        ecs_system(world, {
+            .entity = system,
+            .run = timedSystemRun,
+            .binding_ctx = timer,
+            .binding_ctx_free = ecs_os_api.free_
+        });
+    }
+    history->systemCount = systemCount;
+}
+
+void bc_progressTimed(ecs_world_t *world, bc_ModelTimingHistory *history, float deltaTime) {
+    u32 entry = SDL_AtomicGet(&history->recordedSteps) % BC_MODEL_TIMING_HISTORY_LENGTH;
+    // Systems add into the entry, and not all systems run every step
+    memset(history->systemTimes[entry], 0, sizeof(history->systemTimes[entry]));
+
+    u64 startTime = SDL_GetPerformanceCounter();
+    ecs_progress(world, deltaTime);
+    history->stepTimes[entry] = SDL_GetPerformanceCounter() - startTime;
+
+    u64 *phaseTimes = history->phaseTimes[entry];
+    memset(phaseTimes, 0, sizeof(history->phaseTimes[entry]));
+    for (int i = 0; i < history->systemCount; i++) {
+        phaseTimes[history->systemPhases[i]] += history->systemTimes[entry][i];
+    }
+
+    // Readers use recordedSteps to find the newest complete entry
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicAdd(&history->recordedSteps, 1);
+}
+
+u32 bc_modelTimingEntryCount(const bc_ModelTimingHistory *history) {
+    u32 recorded = SDL_AtomicGet((SDL_atomic_t*)&history->recordedSteps);
+    return MIN(recorded, BC_MODEL_TIMING_HISTORY_LENGTH);
+}
+
+static bool isBuiltin(ecs_world_t *world, ecs_entity_t e) {
+    for (ecs_entity_t p = ecs_get_parent(world, e); p != 0; p = ecs_get_parent(world, p)) {
+        if (p == EcsFlecs) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bc_ModelPhase getSystemPhase(ecs_world_t *world, ecs_entity_t system) {
+    ecs_entity_t phase = ecs_get_target(world, system, EcsDependsOn, 0);
+    if (phase == ApplyCommands) return BC_MODEL_PHASE_APPLY_COMMANDS;
+    if (phase == Prep) return BC_MODEL_PHASE_PREP;
+    if (phase == Execution) return BC_MODEL_PHASE_EXECUTION;
+    if (phase == Resolution) return BC_MODEL_PHASE_RESOLUTION;
+    if (phase == Cleanup) return BC_MODEL_PHASE_CLEANUP;
+    if (phase == AdvanceStep) return BC_MODEL_PHASE_ADVANCE_STEP;
+    if (phase == Planning) return BC_MODEL_PHASE_PLANNING;
+    return BC_MODEL_PHASE_OTHER;
+}
+
+// Same iteration as flecs does for systems without a run callback. Multi threaded systems call this once per stage, so times are summed across all threads
+static void timedSystemRun(ecs_iter_t *it) {
+    SystemTimer *timer = it->binding_ctx;
+    u64 startTime = SDL_GetPerformanceCounter();
+    if (it->field_count > 0) {
+        while (ecs_iter_next(it)) {
+            it->callback(it);
+        }
+    } else {
+        it->callback(it);
+        ecs_iter_fini(it);
+    }
+    u64 duration = SDL_GetPerformanceCounter() - startTime;
+
+    bc_ModelTimingHistory *history = timer->history;
+    u32 entry = SDL_AtomicGet(&history->recordedSteps) % BC_MODEL_TIMING_HISTORY_LENGTH;
+    bc_atomicAddU64(&history->systemTimes[entry][timer->systemIndex], duration);
+}
@@ -0,0 +1,67 @@
+#ifndef BC_MODEL_TIMING_H_INCLUDED
+#define BC_MODEL_TIMING_H_INCLUDED
+
+#include <SDL2/SDL_atomic.h>
+#include "htw_core.h"
+#include "flecs.h"
+
+/* Model timing
+ * High resolution ring buffer of model step, phase, and system times, in SDL_GetPerformanceCounter ticks. Written only by the model thread; other threads may read entries for steps below recordedSteps at any time. An entry can be overwritten while being read if the reader falls a whole history length behind, which is harmless for display.
+ */
+
+#define BC_MODEL_TIMING_HISTORY_LENGTH 300
+#define BC_MODEL_TIMING_MAX_SYSTEMS 128
+#define BC_MODEL_TIMING_NAME_LENGTH 48
+
+// In pipeline order
+typedef enum {
+    BC_MODEL_PHASE_APPLY_COMMANDS,
+    BC_MODEL_PHASE_PREP,
+    BC_MODEL_PHASE_EXECUTION,
+    BC_MODEL_PHASE_RESOLUTION,
+    BC_MODEL_PHASE_CLEANUP,
+    BC_MODEL_PHASE_ADVANCE_STEP,
+    BC_MODEL_PHASE_PLANNING,
+    BC_MODEL_PHASE_OTHER, // builtin flecs phases, e.g. OnLoad or PreUpdate
+    BC_MODEL_PHASE_COUNT
+} bc_ModelPhase;
+
+typedef struct {
+    u64 performanceFrequency;
+    SDL_atomic_t recordedSteps; // number of complete entries written; entry for step s is at s % BC_MODEL_TIMING_HISTORY_LENGTH
+    u64 stepTimes[BC_MODEL_TIMING_HISTORY_LENGTH]; // wall time of the whole ecs_progress call
+    u64 phaseTimes[BC_MODEL_TIMING_HISTORY_LENGTH][BC_MODEL_PHASE_COUNT]; // CPU time: sum of system times in each phase, which can add up to more than the step's wall time when systems run on workers
+    u64 systemTimes[BC_MODEL_TIMING_HISTORY_LENGTH][BC_MODEL_TIMING_MAX_SYSTEMS]; // CPU time: time spent in each system, summed over every thread that ran it
+    // Set once when systems are instrumented
+    u32 systemCount;
+    bc_ModelPhase systemPhases[BC_MODEL_TIMING_MAX_SYSTEMS];
+    char systemNames[BC_MODEL_TIMING_MAX_SYSTEMS][BC_MODEL_TIMING_NAME_LENGTH];
+} bc_ModelTimingHistory;
+
+extern const char *bc_modelPhaseNames[BC_MODEL_PHASE_COUNT];
+
+/**
+ * @brief Wrap every system currently in world with a run callback that records its time into history. Clears any previous history. Systems created afterwards are not timed. Call once after importing model modules
+ *
+ * @param world model world
+ * @param history must outlive the world
+ */
+void bc_instrumentModelSystems(ecs_world_t *world, bc_ModelTimingHistory *history);
+
+/// Progress world once and record its times as the next history entry
+void bc_progressTimed(ecs_world_t *world, bc_ModelTimingHistory *history, float deltaTime);
+
+/// Number of entries that can currently be read, at most BC_MODEL_TIMING_HISTORY_LENGTH
+u32 bc_modelTimingEntryCount(const bc_ModelTimingHistory *history);
+
+/**
+ * @brief Average and max time of every system over the entries that can currently be read, and system indices ordered slowest first
+ *
+ * @param history
+ * @param averagesMs history->systemCount values, in ms
+ * @param maxesMs history->systemCount values, in ms. May be NULL
+ * @param order history->systemCount system indices, sorted by descending average
+ */
+void bc_modelTimingSystemAverages(const bc_ModelTimingHistory *history, float *averagesMs, float *maxesMs, u32 *order);
+
+#endif // BC_MODEL_TIMING_H_INCLUDED
@@ -14,4 +14,5 @@ void BcImport(ecs_world_t *world) {
     ECS_IMPORT(world, BcWildlife);
     ECS_IMPORT(world, BcElementals);
     ECS_IMPORT(world, BcTribes);
+    ECS_IMPORT(world, BcCommands);
 }
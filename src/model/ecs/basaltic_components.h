@@ -8,6 +8,7 @@
 #include "components/basaltic_components_wildlife.h"
 #include "components/bc_components_elementals.h"
 #include "components/bc_components_tribes.h"
+#include "components/bc_components_commands.h"
 
 void BcImport(ecs_world_t *world);
 
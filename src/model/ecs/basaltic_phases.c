@@ -4,6 +4,7 @@
 void BcPhasesImport(ecs_world_t *world) {
     ECS_MODULE(world, BcPhases);
 
+    ECS_TAG_DEFINE(world, ApplyCommands);
     ECS_TAG_DEFINE(world, Prep);
     ECS_TAG_DEFINE(world, Execution);
     ECS_TAG_DEFINE(world, Resolution);
@@ -18,6 +19,8 @@ void BcPhasesImport(ecs_world_t *world) {
 
     ECS_TAG_DEFINE(world, Planning);
 
+    ecs_add_id(world, ApplyCommands, EcsPhase);
+    ecs_add_pair(world, ApplyCommands, EcsDependsOn, EcsOnLoad);
     ecs_add_id(world, Prep, EcsPhase);
     ecs_add_pair(world, Prep, EcsDependsOn, EcsOnUpdate);
     ecs_add_id(world, Execution, EcsPhase);
@@ -31,6 +34,13 @@ void BcPhasesImport(ecs_world_t *world) {
     ecs_add_id(world, Planning, EcsPhase);
     ecs_add_pair(world, Planning, EcsDependsOn, AdvanceStep);
 
+    ApplyCommandsPipeline = ecs_pipeline(world, {
+        .query.filter.terms = {
+            { .id = EcsSystem },
+            { .id = ApplyCommands }
+        }
+    });
+
     // Setup tick sources
     ecs_set_rate(world, TickHour, 1, 0);
     ecs_set_rate(world, TickDay, 24, TickHour);
@@ -12,6 +12,8 @@
 #define BC_DECL
 #endif
 
+// Edits from other threads are applied before anything else in a step
+BC_DECL ECS_TAG_DECLARE(ApplyCommands);
 BC_DECL ECS_TAG_DECLARE(Prep);
 BC_DECL ECS_TAG_DECLARE(Execution);
 BC_DECL ECS_TAG_DECLARE(Resolution);
@@ -20,6 +22,9 @@ BC_DECL ECS_TAG_DECLARE(AdvanceStep);
 // AI actors plan their next move before step ends
 BC_DECL ECS_TAG_DECLARE(Planning);
 
+// Runs only the ApplyCommands phase, to apply edits without advancing the model
+BC_DECL ECS_DECLARE(ApplyCommandsPipeline);
+
 BC_DECL ECS_ENTITY_DECLARE(TickHour);
 BC_DECL ECS_ENTITY_DECLARE(TickDay);
 BC_DECL ECS_ENTITY_DECLARE(TickWeek);
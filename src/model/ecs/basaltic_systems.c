@@ -5,10 +5,12 @@
 #include "basaltic_character_systems.h"
 #include "bc_elementals_systems.h"
 #include "bc_systems_tribes.h"
+#include "bc_systems_commands.h"
 
 void BcSystemsImport(ecs_world_t *world) {
     ECS_MODULE(world, BcSystems);
 
+    ECS_IMPORT(world, BcSystemsCommands);
     ECS_IMPORT(world, BcSystemsCommon);
     ECS_IMPORT(world, BcSystemsTerrain);
     ECS_IMPORT(world, BcSystemsCharacters);
@@ -1,7 +1,10 @@
 #include "bc_flecs_utils.h"
 #define BC_COMPONENT_IMPL
 #include "basaltic_components_planes.h"
+#include "bc_atomic.h"
 #include <math.h>
+#include <stdlib.h>
+#include <string.h>
 
 int serializeCellGeology(const ecs_serializer_t *ser, const void *src) {
     // TODO
@@ -129,7 +132,12 @@ void BcPlanesImport(ecs_world_t *world) {
     ECS_META_COMPONENT(world, ClimateType);
     ECS_META_COMPONENT(world, Season);
     ECS_META_COMPONENT(world, Climate);
+    ECS_META_COMPONENT(world, RateTableResolution);
+    ECS_META_COMPONENT(world, ChunkActivityTier);
+    ECS_META_COMPONENT(world, ChunkLod);
     ECS_META_COMPONENT(world, Plane);
+    ECS_META_COMPONENT(world, RiverSolver);
+    ECS_META_COMPONENT(world, WorldGenTimings);
 
     ECS_COMPONENT_DEFINE(world, HexDirection);
     ecs_enum(world, {
@@ -172,6 +180,10 @@ void BcPlanesImport(ecs_world_t *world) {
     // TODO: the spatial storage should only be accessed from the corresponding get/set methods, and only one is needed per model. Should be a private static var instead of an ECS singleton?
     ecs_singleton_set(world, SpatialStorage, {gm});
 
+    ecs_singleton_set(world, RiverSolver, {RIVER_SOLVER_PARALLEL});
+    ecs_singleton_set(world, RateTableResolution, {.temperatureBuckets = 256, .vegetationBuckets = 256});
+    ecs_singleton_set(world, ChunkLod, {.activeRadius = 1, .distantInterval = 4, .skipSubmerged = true});
+
     // TEST
     // ecs_add_id(world, IsOn, EcsOneOf);
     // Don't do this with the plane component, instead add all planes as children of IsOn
@@ -214,7 +226,10 @@ ecs_entity_t plane_GetRootEntity(ecs_world_t *world, ecs_entity_t plane, Positio
         if (plane_IsValidRootEntity(world, root, plane, pos)) {
             return root;
         } else {
-            kh_del(WorldMap, wm, i);
+            // Systems running on worker threads may call this at the same time, only modify the map from a single thread
+            if (!ecs_stage_is_readonly(world)) {
+                kh_del(WorldMap, wm, i);
+            }
             return 0;
         }
     }
@@ -293,7 +308,45 @@ CellData *bc_getCellByIndex(htw_ChunkMap *chunkMap, u32 chunkIndex, u32 cellInde
     return &cell[cellIndex];
 }
 
-s32 plane_GetCellBiotemperature(const Plane *plane, const Climate *climate, htw_geo_GridCoord pos) {
+void bc_cellRaiseVisibility(CellData *cell, u8 newVisibility) {
+    u8 current = bc_atomicLoadU8(&cell->visibility);
+    while (current < newVisibility) {
+        // on failure, current is updated with the latest value
+        if (bc_atomicCompareExchangeU8(&cell->visibility, &current, newVisibility)) {
+            break;
+        }
+    }
+}
+
+void bc_cellAddTracks(CellData *cell, u32 amount) {
+    u16 current = bc_atomicLoadU16(&cell->tracks);
+    u16 next;
+    do {
+        next = MIN((u32)current + amount, UINT16_MAX);
+    } while (!bc_atomicCompareExchangeU16(&cell->tracks, &current, next));
+}
+
+void bc_cellAddSurfacewater(CellData *cell, u32 amount) {
+    u16 current = bc_atomicLoadU16(&cell->surfacewater);
+    u16 next;
+    do {
+        next = MIN((u32)current + amount, UINT16_MAX);
+    } while (!bc_atomicCompareExchangeU16(&cell->surfacewater, &current, next));
+}
+
+u32 bc_cellConsumeUnderstory(CellData *cell, u32 amount) {
+    u32 current = bc_atomicLoadU32(&cell->understory);
+    u32 consumed;
+    do {
+        consumed = MIN(current, amount);
+    } while (!bc_atomicCompareExchangeU32(&cell->understory, &current, current - consumed));
+    return consumed;
+}
+
+// Shared by every cache, so a version number is never reused even by a different plane's cache
+static u32 biotemperatureVersion = 0;
+
+static s32 computeBiotemperature(const htw_ChunkMap *chunkMap, const Climate *climate, htw_geo_GridCoord pos) {
     s32 latitudeTemp;
     switch(climate->type) {
         case CLIMATE_TYPE_UNIFORM:
@@ -301,12 +354,12 @@ s32 plane_GetCellBiotemperature(const Plane *plane, const Climate *climate, htw_
             break;
         case CLIMATE_TYPE_RADIAL:
             latitudeTemp = htw_geo_circularGradientByGridCoord(
-                plane->chunkMap,
+                chunkMap,
                 pos,
                 (htw_geo_GridCoord){0, 0},
                 climate->poleBiotemp,
                 climate->equatorBiotemp,
-                plane->chunkMap->mapHeight * 0.57735 // = outer radius of equilateral triangle = edge / sqrt(3)
+                chunkMap->mapHeight * 0.57735 // = outer radius of equilateral triangle = edge / sqrt(3)
             );
             break;
         case CLIMATE_TYPE_BANDS:
@@ -316,11 +369,21 @@ s32 plane_GetCellBiotemperature(const Plane *plane, const Climate *climate, htw_
             latitudeTemp = 2000;
             break;
     }
-    s32 elevation = ((CellData*)htw_geo_getCell(plane->chunkMap, pos))->height; // meters * 100
+    s32 elevation = ((CellData*)htw_geo_getCell(chunkMap, pos))->height; // meters * 100
     s32 altitudeTemp = (abs(elevation) * climate->tempChangePerElevationStep);
     return latitudeTemp + altitudeTemp;
 }
 
+s32 plane_GetCellBiotemperature(const Plane *plane, const Climate *climate, htw_geo_GridCoord pos) {
+    const bc_BiotemperatureCache *cache = plane->biotemperature;
+    if (cache != NULL) {
+        u32 chunkIndex, cellIndex;
+        htw_geo_gridCoordinateToChunkAndCellIndex(plane->chunkMap, pos, &chunkIndex, &cellIndex);
+        return cache->values[(chunkIndex * plane->chunkMap->cellsPerChunk) + cellIndex];
+    }
+    return computeBiotemperature(plane->chunkMap, climate, pos);
+}
+
 s32 plane_GetCellTemperature(const Plane *plane, const Climate *climate, htw_geo_GridCoord pos) {
     if (climate == NULL) {
         return 2000; // Neutral ambient temperature if climate is undefined
@@ -331,6 +394,154 @@ s32 plane_GetCellTemperature(const Plane *plane, const Climate *climate, htw_geo
     return biotemp + varyingTemp;
 }
 
+s32 plane_GetCellTemperatureByIndex(const Plane *plane, const Climate *climate, u32 chunkIndex, u32 cellIndex) {
+    if (climate == NULL) {
+        return 2000;
+    }
+    const bc_BiotemperatureCache *cache = plane->biotemperature;
+    if (cache != NULL) {
+        return cache->values[(chunkIndex * plane->chunkMap->cellsPerChunk) + cellIndex] + climate->season.temperatureModifier;
+    }
+    htw_geo_GridCoord pos = htw_geo_chunkAndCellToGridCoordinates(plane->chunkMap, chunkIndex, cellIndex);
+    return computeBiotemperature(plane->chunkMap, climate, pos) + climate->season.temperatureModifier;
+}
+
+bool plane_RefreshBiotemperature(Plane *plane, const Climate *climate) {
+    htw_ChunkMap *cm = plane->chunkMap;
+    u32 chunkCount = cm->chunkCountX * cm->chunkCountY;
+    u32 cellCount = chunkCount * cm->cellsPerChunk;
+    bc_BiotemperatureCache *cache = plane->biotemperature;
+    if (cache != NULL && cache->cellCount == cellCount &&
+        cache->climate.type == climate->type &&
+        cache->climate.poleBiotemp == climate->poleBiotemp &&
+        cache->climate.equatorBiotemp == climate->equatorBiotemp &&
+        cache->climate.tempChangePerElevationStep == climate->tempChangePerElevationStep) {
+        return false;
+    }
+
+    if (cache == NULL || cache->cellCount != cellCount) {
+        plane_FreeBiotemperature(cache);
+        cache = calloc(1, sizeof(bc_BiotemperatureCache));
+        cache->cellCount = cellCount;
+        cache->values = calloc(cellCount, sizeof(cache->values[0]));
+        plane->biotemperature = cache;
+    }
+    cache->climate = *climate;
+    cache->version = bc_atomicAddU32(&biotemperatureVersion, 1);
+    for (u32 c = 0; c < chunkCount; c++) {
+        // Empty chunks are filled in by plane_UpdateChunksBiotemperature once they're generated
+        if (!plane_IsChunkGenerated(plane, c)) {
+            continue;
+        }
+        s32 *values = &cache->values[c * cm->cellsPerChunk];
+        for (u32 cell = 0; cell < cm->cellsPerChunk; cell++) {
+            htw_geo_GridCoord pos = htw_geo_chunkAndCellToGridCoordinates(cm, c, cell);
+            values[cell] = computeBiotemperature(cm, &cache->climate, pos);
+        }
+    }
+    return true;
+}
+
+void plane_UpdateCellBiotemperature(const Plane *plane, htw_geo_GridCoord pos) {
+    bc_BiotemperatureCache *cache = plane->biotemperature;
+    if (cache == NULL) {
+        return;
+    }
+    u32 chunkIndex, cellIndex;
+    htw_geo_gridCoordinateToChunkAndCellIndex(plane->chunkMap, pos, &chunkIndex, &cellIndex);
+    cache->values[(chunkIndex * plane->chunkMap->cellsPerChunk) + cellIndex] = computeBiotemperature(plane->chunkMap, &cache->climate, pos);
+    cache->version = bc_atomicAddU32(&biotemperatureVersion, 1);
+}
+
+void plane_UpdateChunksBiotemperature(const Plane *plane, const u32 *chunkIndices, u32 chunkCount) {
+    bc_BiotemperatureCache *cache = plane->biotemperature;
+    if (cache == NULL || chunkCount == 0) {
+        return;
+    }
+    htw_ChunkMap *cm = plane->chunkMap;
+    for (u32 c = 0; c < chunkCount; c++) {
+        s32 *values = &cache->values[chunkIndices[c] * cm->cellsPerChunk];
+        for (u32 cell = 0; cell < cm->cellsPerChunk; cell++) {
+            htw_geo_GridCoord pos = htw_geo_chunkAndCellToGridCoordinates(cm, chunkIndices[c], cell);
+            values[cell] = computeBiotemperature(cm, &cache->climate, pos);
+        }
+    }
+    cache->version = bc_atomicAddU32(&biotemperatureVersion, 1);
+}
+
+void plane_CopyBiotemperature(bc_BiotemperatureCache **dst, const bc_BiotemperatureCache *src) {
+    bc_BiotemperatureCache *cache = *dst;
+    if (src == NULL) {
+        plane_FreeBiotemperature(cache);
+        *dst = NULL;
+        return;
+    }
+    if (cache == NULL || cache->cellCount != src->cellCount) {
+        plane_FreeBiotemperature(cache);
+        cache = calloc(1, sizeof(bc_BiotemperatureCache));
+        cache->values = malloc(src->cellCount * sizeof(cache->values[0]));
+        // version 0 is never used, so values are always copied below
+        cache->version = 0;
+        *dst = cache;
+    }
+    if (cache->version != src->version) {
+        s32 *values = cache->values;
+        *cache = *src;
+        cache->values = values;
+        memcpy(cache->values, src->values, src->cellCount * sizeof(cache->values[0]));
+    }
+}
+
+void plane_InvalidateBiotemperature(Plane *plane) {
+    plane_FreeBiotemperature(plane->biotemperature);
+    plane->biotemperature = NULL;
+}
+
+void plane_FreeBiotemperature(bc_BiotemperatureCache *cache) {
+    if (cache == NULL) {
+        return;
+    }
+    free(cache->values);
+    free(cache);
+}
+
+bc_ChunkActivity *plane_GetChunkActivity(Plane *plane, u64 step) {
+    htw_ChunkMap *cm = plane->chunkMap;
+    u32 chunkCount = cm->chunkCountX * cm->chunkCountY;
+    bc_ChunkActivity *activity = plane->activity;
+    if (activity != NULL && activity->chunkCount == chunkCount) {
+        return activity;
+    }
+    plane_FreeChunkActivity(activity);
+    activity = malloc(sizeof(bc_ChunkActivity));
+    activity->chunkCount = chunkCount;
+    activity->tiers = malloc(chunkCount * sizeof(activity->tiers[0]));
+    activity->lastUpdateSteps = malloc(chunkCount * sizeof(activity->lastUpdateSteps[0]));
+    for (u32 c = 0; c < chunkCount; c++) {
+        activity->tiers[c] = CHUNK_ACTIVITY_ACTIVE;
+        activity->lastUpdateSteps[c] = step >= 24 ? step - 24 : 0;
+    }
+    plane->activity = activity;
+    return activity;
+}
+
+void plane_FreeChunkActivity(bc_ChunkActivity *activity) {
+    if (activity == NULL) {
+        return;
+    }
+    free(activity->tiers);
+    free(activity->lastUpdateSteps);
+    free(activity);
+}
+
+bool plane_IsChunkResident(const Plane *plane, u32 chunkIndex) {
+    return plane->lazyChunks == NULL || plane->lazyChunks->states[chunkIndex] == LAZY_CHUNK_RESIDENT;
+}
+
+bool plane_IsChunkGenerated(const Plane *plane, u32 chunkIndex) {
+    return plane->lazyChunks == NULL || plane->lazyChunks->states[chunkIndex] != LAZY_CHUNK_EMPTY;
+}
+
 /**
  * @brief Growth rate dependent on understory coverage % and canopy coverage %; low at the extremes and high in the middle
  *
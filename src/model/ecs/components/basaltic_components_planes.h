@@ -129,8 +129,107 @@ ECS_STRUCT(Climate, {
     Season season;
 });
 
+// Biotemperature of every cell on a plane, indexed by (chunkIndex * cellsPerChunk) + cellIndex. Built from the plane's Climate by plane_RefreshBiotemperature, and kept in sync with cell heights by plane_UpdateCellBiotemperature
+typedef struct {
+    u32 cellCount;
+    u32 version; // unique across all caches, and changes whenever any value changes, so copies can skip unchanged caches
+    Climate climate; // values the cache was built from; season is ignored
+    s32 *values;
+} bc_BiotemperatureCache;
+
+// Singleton, number of buckets along each axis of the hydrology rate lookup tables. Changing it rebuilds every plane's tables, and 0 on either axis disables them so rates are computed exactly for every cell. Defaults to 256 x 256
+ECS_STRUCT(RateTableResolution, {
+    u32 temperatureBuckets;
+    u32 vegetationBuckets;
+});
+
+// Hourly evaporation, infiltration, and transpiration rates sampled at the center of each (temperature, vegetation) bucket. Temperature covers every value the plane's Climate can produce, vegetation covers [0, 2 * UINT32_MAX]. Values outside either range use the nearest bucket
+typedef struct {
+    u32 temperatureBuckets;
+    u32 vegetationBuckets;
+    Climate climate; // values the tables were built from; season modifier is ignored
+    s32 minTemperature;
+    float temperatureScale; // buckets per centicelsius
+    float vegetationScale; // buckets per unit of vegetation
+    // Indexed by (temperatureBucket * vegetationBuckets) + vegetationBucket
+    float *evaporation;
+    float *infiltration; // as if unfrozen; callers must still use 0 below freezing
+    float *transpiration;
+} bc_HydrologyRates;
+
+// How often TerrainDailyStep simulates a chunk
+ECS_ENUM(ChunkActivityTier, {
+    // Near an actor or MapVision holder; updated every day
+    CHUNK_ACTIVITY_ACTIVE,
+    // Updated every ChunkLod.distantInterval days, with dT covering every day since its last update
+    CHUNK_ACTIVITY_DISTANT,
+    // Every cell is below sea level; never updated
+    CHUNK_ACTIVITY_SUBMERGED
+});
+
+// Singleton, controls chunk activity tiers. Defaults to an active radius of 1 chunk and distant updates every 4 days
+ECS_STRUCT(ChunkLod, {
+    u32 activeRadius; // in chunks around every actor's chunk. MapVision range is added on top, rounded up to whole chunks
+    u32 distantInterval; // in days, clamped to [1, CHUNK_LOD_MAX_INTERVAL]. 1 updates every chunk every day
+    bool skipSubmerged;
+});
+
+// Limit for ChunkLod.distantInterval. Track decay and vegetation growth don't scale with dT yet, so they slow down in distant chunks by up to this factor
+#define CHUNK_LOD_MAX_INTERVAL 7
+
+// Activity tier of every chunk on a plane, rebuilt once a day by ClassifyChunkActivity and MarkActiveChunks
+typedef struct {
+    u32 chunkCount;
+    u8 *tiers; // ChunkActivityTier, indexed by chunk
+    u64 *lastUpdateSteps; // Step when TerrainDailyStep last simulated (or skipped, if submerged) each chunk
+} bc_ChunkActivity;
+
+// Buffers reused by FormRivers and FlowRivers on one plane; only the terrain systems see inside
+typedef struct bc_RiverScratch bc_RiverScratch;
+
+// Generation state of each chunk on a lazily generated plane
+enum {
+    LAZY_CHUNK_EMPTY, // never generated; cells point to the shared emptyCells block
+    LAZY_CHUNK_BORDER, // generated because a neighboring chunk is resident, but never simulated
+    LAZY_CHUNK_RESIDENT // generated and simulated
+};
+
+// Chunk generation state of a plane created with lazy chunk generation. Chunks are generated from the seed and their chunk index alone, so the order they're first touched in doesn't change their contents. Every neighbor of a resident chunk is generated too, so stencils and river flow never read an empty chunk
+// Cell storage is only allocated when a chunk is generated. Until then its cellData is emptyCells, so stray reads past the generated area (an elemental's line or storm) see zeroed cells instead of faulting
+typedef struct {
+    u32 seed;
+    u32 chunkCount;
+    u32 residentCount;
+    u8 *states; // indexed by chunk
+    CellData *emptyCells; // one chunk of cells shared by every empty chunk; writes to it are never simulated
+} bc_LazyChunks;
+
 ECS_STRUCT(Plane, {
     htw_ChunkMap *chunkMap;
+ECS_PRIVATE
+    bc_LazyChunks *lazyChunks; // NULL if every chunk was generated up front
+    bc_BiotemperatureCache *biotemperature; // NULL until first refreshed
+    bc_ChunkActivity *activity; // NULL until first classified; everything is simulated every day until then
+    bc_HydrologyRates *hydrologyRates; // NULL until first built, or while disabled by RateTableResolution
+    bc_RiverScratch *riverScratch; // NULL until rivers first form or flow
+});
+
+// Singleton, selects how FlowRivers moves groundwater along rivers. Defaults to parallel
+ECS_ENUM(RiverSolver, {
+    // Two phase flux solve: every cell's outflow is computed from the previous state, then applied to every cell at once. Chunks are spread across the JobPool, and results don't depend on thread count
+    RIVER_SOLVER_PARALLEL,
+    // Original serial solver: moves water one cell pair at a time in chunk order, so results depend on iteration order
+    RIVER_SOLVER_LEGACY
+});
+
+// Singleton, wall time of each world generation stage in milliseconds. Set once by ParseArgs when the world is created
+ECS_STRUCT(WorldGenTimings, {
+    float allocateMs;
+    float noiseMs;
+    float erosionMs;
+    float smoothMs;
+    float cacheMs; // loading from or saving to the worldgen cache
+    bool fromCache; // if true, terrain was loaded from the cache and noiseMs is 0
 });
 
 BC_DECL ECS_COMPONENT_DECLARE(HexDirection);
@@ -153,8 +252,21 @@ void plane_MoveEntity(ecs_world_t *world, ecs_entity_t plane, ecs_entity_t e, Po
 
 CellData *bc_getCellByIndex(htw_ChunkMap *chunkMap, u32 chunkIndex, u32 cellIndex);
 
+/* Atomic cell modifiers
+ * Use these instead of read-modify-write on CellData members from multi_threaded systems, where several entities on different worker threads may touch the same cell in one step
+ */
+
+/// Raise cell visibility to at least newVisibility
+void bc_cellRaiseVisibility(CellData *cell, u8 newVisibility);
+/// Add to cell tracks, saturating at UINT16_MAX
+void bc_cellAddTracks(CellData *cell, u32 amount);
+/// Add to cell surfacewater, saturating at UINT16_MAX
+void bc_cellAddSurfacewater(CellData *cell, u32 amount);
+/// Remove up to amount from cell understory, never going below 0. Returns the amount actually removed
+u32 bc_cellConsumeUnderstory(CellData *cell, u32 amount);
+
 /**
- * @brief Represents mean annual temperature at a cell on the plane, determined by distance to the plane origin and cell height. Approximate range from -30c to +30c
+ * @brief Represents mean annual temperature at a cell on the plane, determined by distance to the plane origin and cell height. Approximate range from -30c to +30c. Read from the plane's biotemperature cache if it has one, otherwise computed from climate
  *
  * @param plane p_plane:...
  * @param pos p_pos:...
@@ -163,6 +275,30 @@ CellData *bc_getCellByIndex(htw_ChunkMap *chunkMap, u32 chunkIndex, u32 cellInde
 s32 plane_GetCellBiotemperature(const Plane *plane, const Climate *climate, htw_geo_GridCoord pos);
 /// real temperature that includes seasonal variation
 s32 plane_GetCellTemperature(const Plane *plane, const Climate *climate, htw_geo_GridCoord pos);
+/// Same as plane_GetCellTemperature, for callers already iterating by chunk and cell index
+s32 plane_GetCellTemperatureByIndex(const Plane *plane, const Climate *climate, u32 chunkIndex, u32 cellIndex);
+
+/// (Re)build the plane's biotemperature cache if it doesn't exist yet or climate has changed since it was built. Returns true if rebuilt
+bool plane_RefreshBiotemperature(Plane *plane, const Climate *climate);
+/// Recompute cached biotemperature of one cell; call after changing its height. Does nothing if the plane has no cache
+void plane_UpdateCellBiotemperature(const Plane *plane, htw_geo_GridCoord pos);
+/// Recompute cached biotemperature of every cell in each listed chunk, with one version change for the whole batch. Does nothing if the plane has no cache
+void plane_UpdateChunksBiotemperature(const Plane *plane, const u32 *chunkIndices, u32 chunkCount);
+/// Drop the cache after a pass that changes heights across the whole plane, e.g. bc_smoothTerrain. Temperatures are computed from heights until plane_RefreshBiotemperature rebuilds it
+void plane_InvalidateBiotemperature(Plane *plane);
+/// Copy src into *dst, (re)allocating *dst as needed. Skipped if *dst is already the same version. A NULL src frees *dst
+void plane_CopyBiotemperature(bc_BiotemperatureCache **dst, const bc_BiotemperatureCache *src);
+void plane_FreeBiotemperature(bc_BiotemperatureCache *cache);
+
+/// Allocate the plane's chunk activity if it doesn't exist yet. New chunks start as active and last updated a day before step
+bc_ChunkActivity *plane_GetChunkActivity(Plane *plane, u64 step);
+void plane_FreeChunkActivity(bc_ChunkActivity *activity);
+
+/// False only for chunks of a lazily generated plane that aren't resident yet. Systems that sweep the whole plane skip these
+bool plane_IsChunkResident(const Plane *plane, u32 chunkIndex);
+
+/// False only for chunks of a lazily generated plane that don't have their own cell storage yet. Resident and border chunks are both generated
+bool plane_IsChunkGenerated(const Plane *plane, u32 chunkIndex);
 
 float plane_CanopyGrowthRate(const Plane *plane, htw_geo_GridCoord pos);
 
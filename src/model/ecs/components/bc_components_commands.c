@@ -0,0 +1,8 @@
+#define BC_COMPONENT_IMPL
+#include "bc_components_commands.h"
+
+void BcCommandsImport(ecs_world_t *world) {
+    ECS_MODULE(world, BcCommands);
+
+    ECS_COMPONENT_DEFINE(world, ModelCommandQueue);
+}
@@ -0,0 +1,100 @@
+#ifndef BC_COMPONENTS_COMMANDS_H_INCLUDED
+#define BC_COMPONENTS_COMMANDS_H_INCLUDED
+
+#include "htw_core.h"
+#include "htw_geomap.h"
+#include "flecs.h"
+#include "basaltic_commandBuffer.h"
+
+#undef ECS_META_IMPL
+#undef BC_DECL
+#ifndef BC_COMPONENT_IMPL
+#define ECS_META_IMPL EXTERN
+#define BC_DECL extern
+#else
+#define BC_DECL
+#endif
+
+/* Model commands
+ * Edits to the model requested from other threads, e.g. by editor tools in the view. Pushed onto the ModelCommandQueue ring, and applied by the model thread in the ApplyCommands phase at the start of the next step (or immediately while the model is paused)
+ * Every command struct starts with its type, so the consumer can read any command through a bc_ModelCommandType pointer. Entity ids are from the model world
+ */
+
+typedef enum {
+    BC_COMMAND_CELL_FIELD_ADD, // bc_CellFieldCommand
+    BC_COMMAND_CELL_FIELD_SET, // bc_CellFieldCommand
+    BC_COMMAND_RIVER_CONNECT, // bc_RiverCommand
+    BC_COMMAND_RIVER_DISCONNECT, // bc_RiverCommand
+    BC_COMMAND_SPAWN_PREFAB, // bc_SpawnPrefabCommand
+    BC_COMMAND_SET_DESTINATION, // bc_SetDestinationCommand
+    BC_COMMAND_LOAD_CHUNKS, // bc_LoadChunksCommand
+} bc_ModelCommandType;
+
+// Change one integer field of CellData in every cell within radius of center
+typedef struct {
+    bc_ModelCommandType type;
+    ecs_entity_t plane;
+    htw_geo_GridCoord center;
+    u32 radius;
+    ptrdiff_t fieldOffset; // from start of CellData
+    ecs_primitive_kind_t fieldKind;
+    s64 value; // added to or replaces the field value, clamped to the field type
+} bc_CellFieldCommand;
+
+// Add or remove a river segment between neighboring cells a and b. Ignored if a and b aren't neighbors
+typedef struct {
+    bc_ModelCommandType type;
+    ecs_entity_t plane;
+    htw_geo_GridCoord a;
+    htw_geo_GridCoord b;
+    u8 size; // connect only
+} bc_RiverCommand;
+
+// Instantiate prefab (with randomized fields) on a cell. If prefab is 0, creates an empty entity instead
+typedef struct {
+    bc_ModelCommandType type;
+    ecs_entity_t plane;
+    htw_geo_GridCoord position;
+    ecs_entity_t prefab;
+} bc_SpawnPrefabCommand;
+
+// Give an actor a new destination, and set its action to move there
+typedef struct {
+    bc_ModelCommandType type;
+    ecs_entity_t entity;
+    ecs_entity_t plane;
+    htw_geo_GridCoord destination;
+} bc_SetDestinationCommand;
+
+// Make chunks around center resident on a lazily generated plane, e.g. wherever the view is looking. Ignored on other planes
+typedef struct {
+    bc_ModelCommandType type;
+    ecs_entity_t plane;
+    htw_geo_GridCoord center;
+    u32 chunkRadius;
+} bc_LoadChunksCommand;
+
+// Any model command by value, for producers that need to hold on to commands of mixed types, e.g. while the ring is full
+typedef union {
+    bc_ModelCommandType type;
+    bc_CellFieldCommand cellField;
+    bc_RiverCommand river;
+    bc_SpawnPrefabCommand spawnPrefab;
+    bc_SetDestinationCommand setDestination;
+    bc_LoadChunksCommand loadChunks;
+} bc_ModelCommand;
+
+#define BC_MODEL_COMMAND_RING_SIZE (1 << 16)
+
+// Singleton. Model thread is the only consumer
+typedef struct {
+    bc_CommandBuffer commands;
+} ModelCommandQueue;
+BC_DECL ECS_COMPONENT_DECLARE(ModelCommandQueue);
+
+/// Convenience for pushing any typed command; returns false if the queue is full
+#define bc_pushModelCommand(commandBuffer, command) bc_pushCommandToBuffer(commandBuffer, &(command), sizeof(command))
+
+void BcCommandsImport(ecs_world_t *world);
+
+#endif // BC_COMPONENTS_COMMANDS_H_INCLUDED
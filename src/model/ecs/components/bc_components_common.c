@@ -1,4 +1,5 @@
 #include <sys/stat.h>
+#include "htw_random.h"
 
 #define BC_COMPONENT_IMPL
 #include "bc_components_common.h"
@@ -15,6 +16,8 @@ void BcCommonImport(ecs_world_t *world) {
     ECS_COMPONENT_DEFINE(world, s64);
 
     ECS_COMPONENT_DEFINE(world, Step);
+    ECS_COMPONENT_DEFINE(world, ActorSeed);
+    ECS_COMPONENT_DEFINE(world, JobPool);
     ECS_COMPONENT_DEFINE(world, time_t);
 
     ecs_primitive(world, {.entity = ecs_id(s8), .kind = EcsI8});
@@ -23,11 +26,20 @@ void BcCommonImport(ecs_world_t *world) {
     ecs_primitive(world, {.entity = ecs_id(s64), .kind = EcsI64});
 
     ecs_primitive(world, {.entity = ecs_id(Step), .kind = EcsU64});
+    ecs_primitive(world, {.entity = ecs_id(ActorSeed), .kind = EcsU64});
     ecs_primitive(world, {.entity = ecs_id(time_t), .kind = EcsU64});
 
 
     ECS_META_COMPONENT(world, Args);
 
+    ECS_META_COMPONENT(world, ScheduleMode);
+    ECS_META_COMPONENT(world, AmortizedSystem);
+    ecs_singleton_set(world, ScheduleMode, {SCHEDULE_MODE_BATCHED});
+
+    ECS_META_COMPONENT(world, DeterminismMode);
+    ECS_META_COMPONENT(world, WorldHash);
+    ecs_singleton_set(world, DeterminismMode, {.enabled = false, .seed = 0});
+
 
     ECS_META_COMPONENT(world, RandomizerDistribution);
     ECS_META_COMPONENT(world, RandomizeInt);
@@ -37,3 +49,90 @@ void BcCommonImport(ecs_world_t *world) {
 
     ECS_TAG_DEFINE(world, FlecsScriptSource);
 }
+
+void bc_setAmortizedSystem(ecs_world_t *world, ecs_entity_t system, ecs_entity_t tickSource, u32 periodSteps) {
+    ecs_set(world, system, AmortizedSystem, {.batchedTickSource = tickSource, .periodSteps = MAX(1, periodSteps)});
+    const ScheduleMode *mode = ecs_singleton_get(world, ScheduleMode);
+    bool amortized = mode != NULL && *mode == SCHEDULE_MODE_AMORTIZED;
+    // No tick source means the system runs every step
+    ecs_set_tick_source(world, system, amortized ? 0 : tickSource);
+}
+
+// Returns false in batched mode, or if the running system isn't amortized
+static bool getAmortizedSlot(const ecs_iter_t *it, u32 *slot, u32 *slotCount) {
+    const ScheduleMode *mode = ecs_singleton_get(it->world, ScheduleMode);
+    if (mode == NULL || *mode != SCHEDULE_MODE_AMORTIZED) {
+        return false;
+    }
+    const AmortizedSystem *amortized = ecs_get(it->world, it->system, AmortizedSystem);
+    const Step *step = ecs_singleton_get(it->world, Step);
+    if (amortized == NULL || step == NULL) {
+        return false;
+    }
+    *slotCount = amortized->periodSteps;
+    *slot = *step % amortized->periodSteps;
+    return true;
+}
+
+void bc_amortizedRange(const ecs_iter_t *it, u32 itemCount, u32 *begin, u32 *end) {
+    u32 slot, slotCount;
+    if (!getAmortizedSlot(it, &slot, &slotCount)) {
+        *begin = 0;
+        *end = itemCount;
+        return;
+    }
+    // Slices differ in size by at most 1 item, and cover every item once per period
+    *begin = ((u64)itemCount * slot) / slotCount;
+    *end = ((u64)itemCount * (slot + 1)) / slotCount;
+}
+
+bool bc_amortizedIsDue(const ecs_iter_t *it, u64 key) {
+    u32 slot, slotCount;
+    if (!getAmortizedSlot(it, &slot, &slotCount)) {
+        return true;
+    }
+    return (key % slotCount) == slot;
+}
+
+bc_RandomStream bc_randomStream(const ecs_iter_t *it, u64 key) {
+    const DeterminismMode *mode = ecs_singleton_get(it->world, DeterminismMode);
+    if (mode == NULL || !mode->enabled) {
+        return (bc_RandomStream){.deterministic = false};
+    }
+    const Step *step = ecs_singleton_get(it->world, Step);
+    u64 stepValue = step == NULL ? 0 : *step;
+    // System ids are assigned in import order, so they match between runs
+    u32 words[] = {(u32)it->system, (u32)stepValue, (u32)(stepValue >> 32), (u32)key, (u32)(key >> 32)};
+    return (bc_RandomStream){
+        .deterministic = true,
+        .seed = xxh_hash(mode->seed, sizeof(words), (u8*)words),
+        .counter = 0
+    };
+}
+
+u64 bc_actorKey(const ecs_world_t *world, ecs_entity_t entity) {
+    const ActorSeed *seed = ecs_get(world, entity, ActorSeed);
+    return seed == NULL ? entity : *seed;
+}
+
+u32 bc_randIndex(bc_RandomStream *rs, u32 max) {
+    if (!rs->deterministic) {
+        return htw_randIndex(max);
+    }
+    return xxh_hash2d(rs->seed, rs->counter++, 0) % max;
+}
+
+bool bc_coinFlip(bc_RandomStream *rs) {
+    if (!rs->deterministic) {
+        return htw_coinFlip();
+    }
+    return xxh_hash2d(rs->seed, rs->counter++, 0) & 1;
+}
+
+u64 bc_randU64(bc_RandomStream *rs) {
+    if (!rs->deterministic) {
+        return ((u64)htw_randIndex(UINT32_MAX) << 32) | htw_randIndex(UINT32_MAX);
+    }
+    u64 high = xxh_hash2d(rs->seed, rs->counter++, 0);
+    return (high << 32) | xxh_hash2d(rs->seed, rs->counter++, 0);
+}
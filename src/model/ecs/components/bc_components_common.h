@@ -4,6 +4,7 @@
 #include "htw_core.h"
 #include "flecs.h"
 #include "time.h"
+#include "bc_jobPool.h"
 
 #undef ECS_META_IMPL
 #undef BC_DECL
@@ -23,8 +24,44 @@ BC_DECL ECS_COMPONENT_DECLARE(s64);
 
 typedef u64 Step;
 BC_DECL ECS_COMPONENT_DECLARE(Step);
+
+// Singleton, set when the model world is created. Helper threads for splitting up work on a single entity, like the chunks of a Plane
+typedef struct {
+    bc_JobPool *pool;
+} JobPool;
+BC_DECL ECS_COMPONENT_DECLARE(JobPool);
 BC_DECL ECS_COMPONENT_DECLARE(time_t);
 
+// Singleton. How systems with AmortizedSystem spread out their work. Defaults to batched
+ECS_ENUM(ScheduleMode, {
+    // Do all of the work whenever the system's tick source fires, e.g. the whole map once a day
+    SCHEDULE_MODE_BATCHED,
+    // Run every step and do 1/periodSteps of the work each time, so step times stay even. Every item is still processed once per period
+    SCHEDULE_MODE_AMORTIZED
+});
+
+// On systems that can run in either ScheduleMode; see bc_setAmortizedSystem
+ECS_STRUCT(AmortizedSystem, {
+    ecs_entity_t batchedTickSource;
+    u32 periodSteps; // steps between ticks of batchedTickSource
+});
+
+// Singleton. When enabled, systems draw random numbers from bc_RandomStreams seeded from seed instead of htw_random's shared generator, so results don't depend on worker thread count or scheduling. Seed is set from the world seed on start. Defaults to disabled
+ECS_STRUCT(DeterminismMode, {
+    bool enabled;
+    u32 seed;
+});
+
+// Stable key for an actor's bc_RandomStreams and for ordering its effects in determinism mode. Entity ids are recycled in the order deferred deletes are merged, which depends on worker thread count, so actors created by the model carry a seed drawn from their creator's stream instead. Entities without one are keyed by id
+typedef u64 ActorSeed;
+BC_DECL ECS_COMPONENT_DECLARE(ActorSeed);
+
+// Singleton, only present while world hashing is enabled. Updated at the end of every step with a hash of every plane's CellData and key actor components
+ECS_STRUCT(WorldHash, {
+    u64 step; // step the hash was taken at the end of
+    u64 value;
+});
+
 // Instance field randomizers
 ECS_ENUM(RandomizerDistribution, {
     RAND_DISTRIBUTION_UNIFORM,
@@ -71,4 +108,31 @@ BC_DECL ECS_TAG_DECLARE(FlecsScriptSource);
 
 void BcCommonImport(ecs_world_t *world);
 
+/// Allow system to run amortized over periodSteps, and set its tick source to match the current ScheduleMode. In batched mode the system runs on tickSource, which must tick once every periodSteps
+void bc_setAmortizedSystem(ecs_world_t *world, ecs_entity_t system, ecs_entity_t tickSource, u32 periodSteps);
+/// Range of itemCount items, e.g. chunks, that the running system should process this step: all of them in batched mode, or the current step's slice of the period in amortized mode
+void bc_amortizedRange(const ecs_iter_t *it, u32 itemCount, u32 *begin, u32 *end);
+/// For items without a fixed order, e.g. entities: true if the item identified by key should be processed this step. Always true in batched mode. Key entities with bc_actorKey, since entity ids depend on thread count
+bool bc_amortizedIsDue(const ecs_iter_t *it, u64 key);
+
+/* Random streams
+ * Random numbers for one item, e.g. an entity, in the running system. In determinism mode, each value depends only on DeterminismMode.seed, the system, the step, the item's key, and how many values were drawn from the stream before it. Otherwise, every call falls through to htw_random
+ */
+
+typedef struct {
+    bool deterministic;
+    u32 seed;
+    u32 counter;
+} bc_RandomStream;
+
+bc_RandomStream bc_randomStream(const ecs_iter_t *it, u64 key);
+/// Key for entity's random streams: its ActorSeed if it has one, otherwise its id
+u64 bc_actorKey(const ecs_world_t *world, ecs_entity_t entity);
+/// Same as htw_randIndex: [0, max)
+u32 bc_randIndex(bc_RandomStream *rs, u32 max);
+/// Same as htw_coinFlip
+bool bc_coinFlip(bc_RandomStream *rs);
+/// 64 random bits, e.g. for an ActorSeed
+u64 bc_randU64(bc_RandomStream *rs);
+
 #endif // BC_COMPONENTS_COMMON_H_INCLUDED
@@ -8,6 +8,7 @@
 #include "bc_flecs_utils.h"
 #include <float.h>
 #include <math.h>
+#include <stdlib.h>
 
 // TEST: random movement behavior, pick any adjacent tile to move to
 void setWandererDestinations(ecs_iter_t *it);
@@ -27,6 +28,7 @@ void egoBehaviorPredator(ecs_iter_t *it);
 
 void executeMove(ecs_iter_t *it);
 void executeFeed(ecs_iter_t *it);
+void executeFeedOrdered(ecs_iter_t *it);
 
 void resolveHealth(ecs_iter_t *it);
 
@@ -40,7 +42,8 @@ void egoBehaviorWander(ecs_iter_t *it) {
     Destination *destinations = ecs_field(it, Destination, 2);
 
     for (int i = 0; i < it->count; i++) {
-        destinations[i] = htw_geo_addGridCoords(positions[i], htw_geo_hexGridDirections[htw_randIndex(HEX_DIRECTION_COUNT)]);
+        bc_RandomStream rs = bc_randomStream(it, bc_actorKey(it->world, it->entities[i]));
+        destinations[i] = htw_geo_addGridCoords(positions[i], htw_geo_hexGridDirections[bc_randIndex(&rs, HEX_DIRECTION_COUNT)]);
         ecs_add_pair(it->world, it->entities[i], Action, ActionMove);
     }
 }
@@ -113,7 +116,8 @@ void revealMap(ecs_iter_t *it) {
                 cellVisibility = 1; //BC_TERRAIN_VISIBILITY_GEOMETRY;
             }
 
-            cell->visibility = MAX(cell->visibility, cellVisibility);
+            // Other characters on worker threads may be revealing the same cell
+            bc_cellRaiseVisibility(cell, cellVisibility);
 
             htw_geo_getNextHexSpiralCoord(&relativeCoord);
         }
@@ -163,20 +167,22 @@ void spawnActors(ecs_iter_t *it) {
     ecs_defer_suspend(world);
     for (int i = 0; i < it->count; i++) {
         Spawner sp = spawners[i];
+        bc_RandomStream rs = bc_randomStream(it, bc_actorKey(it->world, it->entities[i]));
         for (int e = 0; e < sp.count; e++) {
             // Must not defer operations to ensure that the same component pointer is accessed across multiple randomizers
             // Otherwise, the temporary storage returned from ecs_get_mut_id will overwrite earlier calls for the same component
             ecs_entity_t newCharacter = bc_instantiateRandomizer(world, sp.prefab);
             // TODO: do position randomization by adding randomizer to prefab?
             htw_geo_GridCoord coord = {
-                .x = htw_randIndex(maxX),
-                .y = htw_randIndex(maxY)
+                .x = bc_randIndex(&rs, maxX),
+                .y = bc_randIndex(&rs, maxY)
             };
             // THEORY: the observer doesn't trigger here, because the entity doesn't yet have both of these components before the function ends, and the merge doesn't trigger OnSet observers as expected
             ecs_add_pair(world, newCharacter, IsIn, planeEntity);
             // TODO: only set position to random map coord if the prefab has a tag like `RandomizePosition`
             ecs_set(world, newCharacter, Position, {coord.x, coord.y});
             ecs_set(world, newCharacter, CreationTime, {*step});
+            ecs_set(world, newCharacter, ActorSeed, {bc_randU64(&rs)});
             // TODO: if instance has Elevation, set to current cell's height
             plane_PlaceEntity(world, planeEntity, newCharacter, coord);
         }
@@ -309,7 +315,8 @@ void egoBehaviorPredator(ecs_iter_t *it) {
         }
         if (!inPersuit) {
             // move randomly
-            destinations[i] = htw_geo_addGridCoords(positions[i], htw_geo_hexGridDirections[htw_randIndex(HEX_DIRECTION_COUNT)]);
+            bc_RandomStream rs = bc_randomStream(it, bc_actorKey(it->world, it->entities[i]));
+            destinations[i] = htw_geo_addGridCoords(positions[i], htw_geo_hexGridDirections[bc_randIndex(&rs, HEX_DIRECTION_COUNT)]);
         }
         ecs_add_pair(it->world, it->entities[i], Action, ActionMove);
     }
@@ -348,37 +355,92 @@ void executeMove(ecs_iter_t *it) {
     }
 }
 
+// Eat from cell and restore stamina in proportion to what was eaten. group may be NULL
+static void feed(CellData *cell, Condition *condition, const Group *group) {
+    if (group != NULL) {
+        // multiply consumed amount by group size
+        s64 required = group->count * 4096 * 5; // TODO: multiply by size?; TODO: this number is a hacky way to represent expected consumption with 32-bit veg range
+        // Multiple groups can share a cell, so cell changes must be atomic when run on worker threads
+        s64 consumed = bc_cellConsumeUnderstory(cell, MIN(required, UINT32_MAX));
+        bc_cellAddTracks(cell, group->count); // * size^2?
+        // Restore up to half of max each meal TODO best rounding method?
+        s32 restored = roundf( ((float)condition->maxStamina / 2) * ((float)consumed / required) );
+        condition->stamina = MIN(condition->stamina + restored, condition->maxStamina);
+    } else {
+        bc_cellConsumeUnderstory(cell, 1);
+        s32 restored = condition->maxStamina / 2; // Restore half of max each meal
+        condition->stamina = MIN(condition->stamina + restored, condition->maxStamina);
+    }
+}
+
 void executeFeed(ecs_iter_t *it) {
+    // Which group eats first from a shared cell depends on thread scheduling, so executeFeedOrdered feeds everyone instead
+    const DeterminismMode *determinism = ecs_singleton_get(it->world, DeterminismMode);
+    if (determinism != NULL && determinism->enabled) {
+        return;
+    }
+
     Position *positions = ecs_field(it, Position, 1);
     htw_ChunkMap *cm = ecs_field(it, Plane, 2)->chunkMap;
     ecs_entity_t diet = ecs_pair_second(it->world, ecs_field_id(it, 3));
     Condition *conditions = ecs_field(it, Condition, 4);
-    if (ecs_field_is_set(it, 5)) {
-        // multiply consumed amount by group size
-        Group *groups = ecs_field(it, Group, 5);
-        for (int i = 0; i < it->count; i++) {
-            CellData *cell = htw_geo_getCell(cm, positions[i]);
-            s64 understory = cell->understory;
-            s64 tracks = cell->tracks;
-            s64 required = groups[i].count * 4096 * 5; // TODO: multiply by size?; TODO: this number is a hacky way to represent expected consumption with 32-bit veg range
-            s64 consumed = MIN(understory, required);
-            understory -= consumed;
-            tracks += groups[i].count; // * size^2?
-            cell->understory = MAX(0, understory);
-            cell->tracks = MIN(tracks, UINT16_MAX);
-            // Restore up to half of max each meal TODO best rounding method?
-            s32 restored = roundf( ((float)conditions[i].maxStamina / 2) * ((float)consumed / required) );
-            conditions[i].stamina = MIN(conditions[i].stamina + restored, conditions[i].maxStamina);
-        }
-    } else {
-        for (int i = 0; i < it->count; i++) {
-            CellData *cell = htw_geo_getCell(cm, positions[i]);
-            s32 consumed = MIN(cell->understory, 1);
-            cell->understory -= consumed;
-            s32 restored = conditions[i].maxStamina / 2; // Restore half of max each meal
-            conditions[i].stamina = MIN(conditions[i].stamina + restored, conditions[i].maxStamina);
+    Group *groups = ecs_field_is_set(it, 5) ? ecs_field(it, Group, 5) : NULL;
+    for (int i = 0; i < it->count; i++) {
+        feed(htw_geo_getCell(cm, positions[i]), &conditions[i], groups == NULL ? NULL : &groups[i]);
+    }
+}
+
+typedef struct {
+    u64 key;
+    ecs_entity_t entity;
+    CellData *cell;
+    Condition *condition;
+    const Group *group;
+} Feeder;
+
+static int compareFeeders(const void *a, const void *b) {
+    const Feeder *fa = a;
+    const Feeder *fb = b;
+    if (fa->key != fb->key) {
+        return (fa->key > fb->key) - (fa->key < fb->key);
+    }
+    return (fa->entity > fb->entity) - (fa->entity < fb->entity);
+}
+
+// Determinism mode only: collects every feeding actor, then feeds them one at a time in ActorSeed order, so a shared cell is eaten in the same order regardless of thread count or table layout
+void executeFeedOrdered(ecs_iter_t *it) {
+    const DeterminismMode *determinism = ecs_field(it, DeterminismMode, 1);
+    if (!determinism->enabled) {
+        return;
+    }
+
+    ecs_query_t *query = it->ctx;
+    Feeder *feeders = NULL;
+    u32 feederCount = 0;
+    ecs_iter_t fit = ecs_query_iter(it->world, query);
+    while (ecs_query_next(&fit)) {
+        Position *positions = ecs_field(&fit, Position, 1);
+        htw_ChunkMap *cm = ecs_field(&fit, Plane, 2)->chunkMap;
+        Condition *conditions = ecs_field(&fit, Condition, 4);
+        Group *groups = ecs_field_is_set(&fit, 5) ? ecs_field(&fit, Group, 5) : NULL;
+        ActorSeed *seeds = ecs_field_is_set(&fit, 6) ? ecs_field(&fit, ActorSeed, 6) : NULL;
+        feeders = realloc(feeders, (feederCount + fit.count) * sizeof(Feeder));
+        for (int i = 0; i < fit.count; i++, feederCount++) {
+            feeders[feederCount] = (Feeder){
+                .key = seeds == NULL ? fit.entities[i] : seeds[i],
+                .entity = fit.entities[i],
+                .cell = htw_geo_getCell(cm, positions[i]),
+                .condition = &conditions[i],
+                .group = groups == NULL ? NULL : &groups[i],
+            };
         }
     }
+
+    qsort(feeders, feederCount, sizeof(Feeder), compareFeeders);
+    for (u32 f = 0; f < feederCount; f++) {
+        feed(feeders[f].cell, feeders[f].condition, feeders[f].group);
+    }
+    free(feeders);
 }
 
 void resolveHealth(ecs_iter_t *it) {
@@ -449,6 +511,9 @@ void tickGrowth(ecs_iter_t *it) {
     Group *groups = ecs_field(it, Group, 2);
 
     for (int i = 0; i < it->count; i++) {
+        if (!bc_amortizedIsDue(it, bc_actorKey(it->world, it->entities[i]))) {
+            continue;
+        }
         growthRates[i].progress += groups[i].count * (24 / 2); // Once per hour for every 2 in the group
         if (growthRates[i].progress >= growthRates[i].stepsRequired) {
             growthRates[i].progress = 0;
@@ -489,6 +554,10 @@ void BcSystemsCharactersImport(ecs_world_t *world) {
         [in] Plane(up(bc.planes.IsIn)),
         [in] MapVision
     );
+    ecs_system(world, {
+        .entity = revealMap,
+        .multi_threaded = true
+    });
 
     // TODO: try out observers only for position changes
     // NOTE: observers can propogate events along traversable relationships, meaning that when Plane is set, this event triggers for all entities on that plane
@@ -557,15 +626,44 @@ void BcSystemsCharactersImport(ecs_world_t *world) {
                [in] Position,
                [in] Plane(up(bc.planes.IsIn)),
                [in] (bc.wildlife.Diet, _),
-               [in] Condition,
+               [inout] Condition,
                [in] ?Group,
                [none] (bc.actors.Action, bc.actors.Action.ActionFeed)
     );
+    ecs_system(world, {
+        .entity = executeFeed,
+        .multi_threaded = true
+    });
+
+    // Same actors as executeFeed, for executeFeedOrdered to iterate in one pass
+    ecs_query_t *feeders = ecs_query(world, {
+        .filter.terms = {
+            {.id = ecs_id(Position), .inout = EcsIn},
+            {.id = ecs_id(Plane), .inout = EcsIn, .src = {.flags = EcsUp, .trav = IsIn}},
+            {.id = ecs_pair(Diet, EcsWildcard), .inout = EcsIn},
+            {.id = ecs_id(Condition), .inout = EcsInOut},
+            {.id = ecs_id(Group), .inout = EcsIn, .oper = EcsOptional},
+            {.id = ecs_id(ActorSeed), .inout = EcsIn, .oper = EcsOptional},
+            {.id = ecs_pair(Action, ActionFeed), .inout = EcsInOutNone}
+        }
+    });
+    ECS_SYSTEM(world, executeFeedOrdered, Execution,
+               [in] DeterminismMode($)
+    );
+    ecs_system(world, {
+        .entity = executeFeedOrdered,
+        .ctx = feeders
+    });
 
     ECS_SYSTEM(world, resolveHealth, Resolution,
                [inout] Condition,
                [inout] Group
     );
+    // Deletes are deferred per stage, so this is safe on worker threads
+    ecs_system(world, {
+        .entity = resolveHealth,
+        .multi_threaded = true
+    });
 
     // TODO: might want to remove this system and instead make group splitting and merging the outcome of an event, which has a chance of appearing when 2 groups cross paths or a group is large enough
     ECS_SYSTEM(world, mergeGroups, Cleanup,
@@ -584,9 +682,17 @@ void BcSystemsCharactersImport(ecs_world_t *world) {
         [inout] GrowthRate,
         [inout] Group
     );
-    ecs_set_tick_source(world, tickGrowth, TickDay);
+    bc_setAmortizedSystem(world, tickGrowth, TickDay, 24);
+    ecs_system(world, {
+        .entity = tickGrowth,
+        .multi_threaded = true
+    });
 
     ECS_SYSTEM(world, tickStamina, AdvanceStep,
         [inout] Condition
     );
+    ecs_system(world, {
+        .entity = tickStamina,
+        .multi_threaded = true
+    });
 }
@@ -4,10 +4,17 @@
 #include "components/basaltic_components_planes.h"
 #include "htw_core.h"
 #include "basaltic_worldGen.h"
+#include "bc_haloChunkMap.h"
+#include "htw_random.h"
 #include "khash.h"
 #include <math.h>
+#include <stdlib.h>
+#include <string.h>
 
 #define MAX_DROUGHT_TOLERANCE (1<<13)
+// Same as the TickMonth and TickYear rates
+#define HOURS_PER_MONTH (24 * 7 * 4)
+#define HOURS_PER_YEAR (HOURS_PER_MONTH * 12)
 
 // water units in ML/km^2 aka 0.1 mL/cm^2; 1 ML == 1 mm of water over 1 km^2 (one tile area)
 float infiltrationPerHour(s32 temp, s64 groundwater, s64 vegetation);
@@ -19,6 +26,10 @@ float potentialEvapotranspirationPerHour(s32 temp, s64 vegetation);
 /// dT: number of hours to simulate for each cell
 void chunkUpdate(Plane *plane, const Climate *climate, size_t chunkIndex, s64 dT);
 void riverUpdate(Plane *plane, size_t chunkIndex, s64 dT);
+/// Parallel river solver phase 1: write each cell's outflow in every direction to outflows, reading only the current cell state. Neighbors are read from halo, which must be refreshed for chunkIndex
+void riverComputeOutflows(const Plane *plane, const bc_HaloChunkMap *halo, size_t chunkIndex, s64 dT, u16 (*outflows)[HEX_DIRECTION_COUNT]);
+/// Parallel river solver phase 2: apply outflows from phase 1 to every cell in the chunk. Only writes cells in its own chunk
+void riverApplyOutflows(Plane *plane, size_t chunkIndex, const u16 (*outflows)[HEX_DIRECTION_COUNT]);
 
 // TODO: move these simulation rate functions into a public header and add a way to visualize any of them on terrain with a gradient
 
@@ -51,97 +62,486 @@ float transpirationPerHour(s32 temp, s64 vegetation) {
     return MAX(0.0, total);
 }
 
+/* Hydrology rate tables
+ * The rate functions above only depend on temperature and vegetation, so they can be sampled once per plane into tables instead of evaluated for every cell every day. Within a bucket, rates are those of the bucket center, so results differ slightly from the exact functions. With the default 256 x 256 buckets, a temperature bucket spans a few tenths of a degree
+ */
+
+static bool hydrologyRatesMatch(const bc_HydrologyRates *rates, const Climate *climate, const RateTableResolution *resolution) {
+    return rates->temperatureBuckets == resolution->temperatureBuckets &&
+           rates->vegetationBuckets == resolution->vegetationBuckets &&
+           rates->climate.type == climate->type &&
+           rates->climate.poleBiotemp == climate->poleBiotemp &&
+           rates->climate.equatorBiotemp == climate->equatorBiotemp &&
+           rates->climate.tempChangePerElevationStep == climate->tempChangePerElevationStep &&
+           rates->climate.season.temperatureRange == climate->season.temperatureRange;
+}
+
+static void freeHydrologyRates(bc_HydrologyRates *rates) {
+    if (rates == NULL) {
+        return;
+    }
+    free(rates->evaporation);
+    free(rates->infiltration);
+    free(rates->transpiration);
+    free(rates);
+}
+
+static bc_HydrologyRates *buildHydrologyRates(const Climate *climate, const RateTableResolution *resolution) {
+    // Every temperature plane_GetCellTemperature can return for this climate
+    s32 lowTemp = MIN(climate->poleBiotemp, climate->equatorBiotemp);
+    s32 highTemp = MAX(climate->poleBiotemp, climate->equatorBiotemp);
+    s32 altitudeTemp = -INT8_MIN * climate->tempChangePerElevationStep;
+    lowTemp += MIN(0, altitudeTemp) - abs(climate->season.temperatureRange);
+    highTemp += MAX(0, altitudeTemp) + abs(climate->season.temperatureRange);
+
+    u32 tBuckets = resolution->temperatureBuckets;
+    u32 vBuckets = resolution->vegetationBuckets;
+    bc_HydrologyRates *rates = malloc(sizeof(bc_HydrologyRates));
+    *rates = (bc_HydrologyRates){
+        .temperatureBuckets = tBuckets,
+        .vegetationBuckets = vBuckets,
+        .climate = *climate,
+        .minTemperature = lowTemp,
+        .temperatureScale = (float)tBuckets / (float)MAX(1, highTemp - lowTemp),
+        .vegetationScale = (float)vBuckets / (2.0f * UINT32_MAX),
+        .evaporation = malloc(tBuckets * vBuckets * sizeof(float)),
+        .infiltration = malloc(tBuckets * vBuckets * sizeof(float)),
+        .transpiration = malloc(tBuckets * vBuckets * sizeof(float)),
+    };
+    for (u32 t = 0; t < tBuckets; t++) {
+        s32 temp = lowTemp + (s32)((t + 0.5f) / rates->temperatureScale);
+        for (u32 v = 0; v < vBuckets; v++) {
+            s64 vegetation = (v + 0.5f) / rates->vegetationScale;
+            u32 i = (t * vBuckets) + v;
+            rates->evaporation[i] = evaporationPerHour(temp, vegetation);
+            // Freezing cutoff is applied on lookup, so a bucket spanning 0c doesn't smear it
+            rates->infiltration[i] = infiltrationPerHour(MAX(0, temp), 0, vegetation);
+            rates->transpiration[i] = transpirationPerHour(temp, vegetation);
+        }
+    }
+    return rates;
+}
+
+static u32 hydrologyRateIndex(const bc_HydrologyRates *rates, s32 temp, s64 vegetation) {
+    s32 t = (temp - rates->minTemperature) * rates->temperatureScale;
+    s64 v = vegetation * rates->vegetationScale;
+    t = CLAMP(t, 0, (s32)rates->temperatureBuckets - 1);
+    v = CLAMP(v, 0, (s64)rates->vegetationBuckets - 1);
+    return (t * rates->vegetationBuckets) + v;
+}
+
+// Scalar hydrology and vegetation update for one cell. Reference for the SIMD path in chunkUpdate
+static void cellUpdate(Plane *plane, const Climate *climate, size_t chunkIndex, u32 cellIndex, CellData *cell, s64 dT) {
+    // don't need to do anything if cell is below sea level
+    if (cell->height < 0) {
+        cell->groundwater = 0;
+        cell->surfacewater = 0;
+        return;
+    }
+
+    s32 temp = plane_GetCellTemperatureByIndex(plane, climate, chunkIndex, cellIndex);
+    bool isGrowingSeason = temp > 0 && temp < 3000; // between 0 and 30 c; possibly too wide
+
+    // Expand celldata fields to avoid overflows
+    s64 tracks = cell->tracks;
+    s64 groundwater = cell->groundwater;
+    s64 surfacewater = cell->surfacewater;
+    s64 humidityPreference = cell->humidityPreference;
+    s64 understory = cell->understory;
+    s64 canopy = cell->canopy;
+
+    // erase tracks TODO: effect should scale with dT
+    tracks = MIN(tracks * 0.98, tracks - 1);
+
+    s64 vegetationCoverage = MAX(understory + canopy, UINT32_MAX);
+    const bc_HydrologyRates *rates = plane->hydrologyRates;
+    float evaporationRate, infiltrationRate, transpirationRate;
+    if (rates != NULL) {
+        u32 r = hydrologyRateIndex(rates, temp, vegetationCoverage);
+        evaporationRate = rates->evaporation[r];
+        infiltrationRate = temp < 0 ? 0.0 : rates->infiltration[r];
+        transpirationRate = rates->transpiration[r];
+    } else {
+        evaporationRate = evaporationPerHour(temp, vegetationCoverage);
+        infiltrationRate = infiltrationPerHour(temp, groundwater, vegetationCoverage);
+        transpirationRate = transpirationPerHour(temp, vegetationCoverage);
+    }
+    s64 evaporation = evaporationRate * dT;
+
+    // surface water enters the ground and evaporates
+    if (surfacewater > 0) {
+        s64 infiltration = infiltrationRate * dT;
+        s64 groundAvailableCapacity = INT16_MAX - groundwater;
+        s64 limit = MIN(surfacewater, groundAvailableCapacity); // can't transfer more than is available or more than destination can accept
+        infiltration = MIN(infiltration, limit);
+        // if groundwater in negative, start from 1 so frozen surface water doesn't 'dry out' the tile
+        groundwater = MAX(1, groundwater) + infiltration;
+        surfacewater -= evaporation + infiltration;
+    }
+
+    if (groundwater <= 0) {
+        // Track hours since water was available
+        groundwater -= dT;
+        // kill vegetation if dry longer than drought resistance threshold
+        if (-groundwater > (MAX_DROUGHT_TOLERANCE - humidityPreference)) {
+            // lower humidity preference
+            humidityPreference -= 1 * dT;
+            // TODO: dieoff should scale with dT
+            understory *= 0.98;
+            canopy *= 0.98;
+        }
+    } else if (isGrowingSeason) {
+        // raise humidity preference
+        humidityPreference += 1 * dT;
+        // Remove groundwater according to evapotranspiration
+        s64 transpiration = transpirationRate;
+        groundwater -= (evaporation + transpiration);
+        // grow new vegetation
+        // 100 days to reach full understory
+        understory += (0.01 * UINT32_MAX);
+
+        // should take ~100 years to reach full canopy, but numbers are less clear because of variable growth rate
+        // TODO: high tracks % should slow early canopy growth, very high tracks % should slow understory growth
+        float canopyGrowth = plane_CanopyGrowthRate(plane, htw_geo_chunkAndCellToGridCoordinates(plane->chunkMap, chunkIndex, cellIndex));
+        canopy += (canopyGrowth * 0.0005 * UINT32_MAX);
+    } else {
+        // dry weather outside of growing season doesn't effect humidity preference
+        // Remove groundwater according to evaporation TODO
+        groundwater -= evaporation;
+    }
+
+    // Clamp values before assigning back to cell
+    cell->tracks = CLAMP(tracks, 0, UINT16_MAX);
+    cell->groundwater = CLAMP(groundwater, INT16_MIN, INT16_MAX);
+    cell->surfacewater = CLAMP(surfacewater, 0, UINT16_MAX);
+    cell->humidityPreference = CLAMP(humidityPreference, 0, UINT16_MAX);
+    cell->understory = CLAMP(understory, 0, UINT32_MAX);
+    cell->canopy = CLAMP(canopy, 0, UINT32_MAX);
+}
+
+/* SIMD hydrology
+ * chunkUpdate runs cellUpdate's water and track math on HYDROLOGY_LANES cells at once, with every branch replaced by a lane mask. Cell fields are staged into s32 lanes, which hold every intermediate value without overflow for dT of a few days or less. Vegetation changes are rare and need 64 bit intermediates, so the kernel only flags which lanes die off or grow and the staging loop applies them with the same scalar math as cellUpdate
+ * Tolerance vs. cellUpdate: rates here are single precision, while the scalar rate functions mix in double precision, so truncated evaporation, infiltration, and transpiration can each differ by 1 per update when a rate lands within rounding of a whole number; the same goes for tracks * 0.98. groundwater and surfacewater may therefore drift by at most 2 and tracks by at most 1 per call. Sea level and growing season masks, and anything derived from integer fields only, match exactly
+ */
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define HYDROLOGY_LANES 8
+typedef __m256i vs32;
+typedef __m256 vf32;
+#define vs32_load(p) _mm256_loadu_si256((const __m256i*)(p))
+#define vs32_store(p, v) _mm256_storeu_si256((__m256i*)(p), v)
+#define vs32_set1 _mm256_set1_epi32
+#define vs32_add _mm256_add_epi32
+#define vs32_sub _mm256_sub_epi32
+#define vs32_min _mm256_min_epi32
+#define vs32_max _mm256_max_epi32
+#define vs32_gt _mm256_cmpgt_epi32
+#define vs32_and _mm256_and_si256
+#define vs32_or _mm256_or_si256
+#define vs32_andnot _mm256_andnot_si256 // (~mask) & v
+#define vs32_select(mask, a, b) _mm256_blendv_epi8(b, a, mask)
+#define vs32_truncate _mm256_cvttps_epi32
+#define vf32_load _mm256_loadu_ps
+#define vf32_set1 _mm256_set1_ps
+#define vf32_add _mm256_add_ps
+#define vf32_sub _mm256_sub_ps
+#define vf32_mul _mm256_mul_ps
+#define vf32_div _mm256_div_ps
+#define vf32_max _mm256_max_ps
+#define vf32_convert _mm256_cvtepi32_ps
+#elif defined(__SSE4_1__) || defined(BASALTIC_SSE4_1) // MSVC doesn't define __SSE4_1__, so CMake defines BASALTIC_SSE4_1 instead
+#include <smmintrin.h>
+#define HYDROLOGY_LANES 4
+typedef __m128i vs32;
+typedef __m128 vf32;
+#define vs32_load(p) _mm_loadu_si128((const __m128i*)(p))
+#define vs32_store(p, v) _mm_storeu_si128((__m128i*)(p), v)
+#define vs32_set1 _mm_set1_epi32
+#define vs32_add _mm_add_epi32
+#define vs32_sub _mm_sub_epi32
+#define vs32_min _mm_min_epi32
+#define vs32_max _mm_max_epi32
+#define vs32_gt _mm_cmpgt_epi32
+#define vs32_and _mm_and_si128
+#define vs32_or _mm_or_si128
+#define vs32_andnot _mm_andnot_si128 // (~mask) & v
+#define vs32_select(mask, a, b) _mm_blendv_epi8(b, a, mask)
+#define vs32_truncate _mm_cvttps_epi32
+#define vf32_load _mm_loadu_ps
+#define vf32_set1 _mm_set1_ps
+#define vf32_add _mm_add_ps
+#define vf32_sub _mm_sub_ps
+#define vf32_mul _mm_mul_ps
+#define vf32_div _mm_div_ps
+#define vf32_max _mm_max_ps
+#define vf32_convert _mm_cvtepi32_ps
+#endif
+
+#ifdef HYDROLOGY_LANES
+
+enum {
+    VEGETATION_UNCHANGED = 0,
+    VEGETATION_DIEOFF = 1,
+    VEGETATION_GROW = 2
+};
+
+typedef struct {
+    s32 height[HYDROLOGY_LANES];
+    s32 temperature[HYDROLOGY_LANES];
+    s32 tracks[HYDROLOGY_LANES];
+    s32 groundwater[HYDROLOGY_LANES];
+    s32 surfacewater[HYDROLOGY_LANES];
+    s32 humidityPreference[HYDROLOGY_LANES];
+    s32 vegetationChange[HYDROLOGY_LANES];
+    float vegetationFactor[HYDROLOGY_LANES];
+    // Only staged when the plane has hydrology rate tables; otherwise the kernel computes rates from temperature and vegetationFactor
+    float evaporationRate[HYDROLOGY_LANES];
+    float infiltrationRate[HYDROLOGY_LANES];
+    float transpirationRate[HYDROLOGY_LANES];
+} HydrologyLanes;
+
+static vs32 vs32_clamp(vs32 v, s32 low, s32 high) {
+    return vs32_min(vs32_max(v, vs32_set1(low)), vs32_set1(high));
+}
+
+static void hydrologyKernel(HydrologyLanes *lanes, s32 dT, bool stagedRates) {
+    const vs32 zero = vs32_set1(0);
+    const vs32 one = vs32_set1(1);
+    const vs32 dTi = vs32_set1(dT);
+    const vf32 dTf = vf32_set1(dT);
+
+    vs32 height = vs32_load(lanes->height);
+    vs32 temp = vs32_load(lanes->temperature);
+    vs32 tracks = vs32_load(lanes->tracks);
+    vs32 groundwater = vs32_load(lanes->groundwater);
+    vs32 surfacewater = vs32_load(lanes->surfacewater);
+    vs32 humidityPreference = vs32_load(lanes->humidityPreference);
+    vf32 vegFactor = vf32_load(lanes->vegetationFactor);
+    vf32 tempFactor = vf32_div(vf32_convert(temp), vf32_set1(4000.0f));
+
+    vs32 isSea = vs32_gt(zero, height);
+    vs32 isGrowingSeason = vs32_and(vs32_gt(temp, zero), vs32_gt(vs32_set1(3000), temp));
+
+    vs32 newTracks = vs32_min(vs32_truncate(vf32_mul(vf32_convert(tracks), vf32_set1(0.98f))), vs32_sub(tracks, one));
+
+    // rates, same as evaporationPerHour, infiltrationPerHour, and transpirationPerHour
+    vf32 evaporationRate, infiltrationRate, transpirationRate;
+    if (stagedRates) {
+        evaporationRate = vf32_load(lanes->evaporationRate);
+        infiltrationRate = vf32_load(lanes->infiltrationRate);
+        transpirationRate = vf32_load(lanes->transpirationRate);
+    } else {
+        evaporationRate = vf32_max(vf32_set1(0.0f), vf32_mul(vf32_sub(tempFactor, vf32_mul(vegFactor, vf32_set1(0.25f))), vf32_set1(0.3f)));
+        infiltrationRate = vf32_add(vf32_set1(10.0f), vf32_mul(vegFactor, vf32_set1(300.0f)));
+        transpirationRate = vf32_max(vf32_set1(0.0f), vf32_mul(vf32_add(vegFactor, vf32_mul(tempFactor, vf32_set1(0.25f))), vf32_set1(0.3f)));
+    }
+    vs32 evaporation = vs32_truncate(vf32_mul(evaporationRate, dTf));
+    vs32 infiltration = vs32_andnot(vs32_gt(zero, temp), vs32_truncate(vf32_mul(infiltrationRate, dTf)));
+    vs32 transpiration = vs32_truncate(transpirationRate);
+
+    // surface water enters the ground and evaporates
+    vs32 hasSurfacewater = vs32_gt(surfacewater, zero);
+    infiltration = vs32_min(infiltration, vs32_min(surfacewater, vs32_sub(vs32_set1(INT16_MAX), groundwater)));
+    groundwater = vs32_select(hasSurfacewater, vs32_add(vs32_max(one, groundwater), infiltration), groundwater);
+    surfacewater = vs32_select(hasSurfacewater, vs32_sub(surfacewater, vs32_add(evaporation, infiltration)), surfacewater);
+
+    // dry cells count hours without water, and vegetation dies if dry for too long
+    vs32 isDry = vs32_gt(one, groundwater);
+    vs32 dryGroundwater = vs32_sub(groundwater, dTi);
+    vs32 isDieoff = vs32_and(isDry, vs32_gt(vs32_sub(zero, dryGroundwater), vs32_sub(vs32_set1(MAX_DROUGHT_TOLERANCE), humidityPreference)));
+    vs32 isGrowing = vs32_andnot(isDry, isGrowingSeason);
+
+    groundwater = vs32_select(isDry, dryGroundwater,
+                              vs32_select(isGrowing, vs32_sub(groundwater, vs32_add(evaporation, transpiration)), vs32_sub(groundwater, evaporation)));
+    vs32 newHumidity = vs32_select(isDieoff, vs32_sub(humidityPreference, dTi),
+                                   vs32_select(isGrowing, vs32_add(humidityPreference, dTi), humidityPreference));
+    vs32 vegetationChange = vs32_or(vs32_and(isDieoff, vs32_set1(VEGETATION_DIEOFF)), vs32_and(isGrowing, vs32_set1(VEGETATION_GROW)));
+
+    // sea cells only lose their water
+    vs32_store(lanes->tracks, vs32_clamp(vs32_select(isSea, tracks, newTracks), 0, UINT16_MAX));
+    vs32_store(lanes->groundwater, vs32_clamp(vs32_andnot(isSea, groundwater), INT16_MIN, INT16_MAX));
+    vs32_store(lanes->surfacewater, vs32_clamp(vs32_andnot(isSea, surfacewater), 0, UINT16_MAX));
+    vs32_store(lanes->humidityPreference, vs32_clamp(vs32_select(isSea, humidityPreference, newHumidity), 0, UINT16_MAX));
+    vs32_store(lanes->vegetationChange, vs32_andnot(isSea, vegetationChange));
+}
+
+static void hydrologyUpdate(Plane *plane, const Climate *climate, size_t chunkIndex, u32 firstCell, CellData *cells, s32 dT) {
+    htw_ChunkMap *cm = plane->chunkMap;
+    const bc_HydrologyRates *rates = plane->hydrologyRates;
+    HydrologyLanes lanes;
+    for (int i = 0; i < HYDROLOGY_LANES; i++) {
+        const CellData *cell = &cells[i];
+        lanes.height[i] = cell->height;
+        // sea cells ignore temperature
+        lanes.temperature[i] = cell->height < 0 ? 0 : plane_GetCellTemperatureByIndex(plane, climate, chunkIndex, firstCell + i);
+        lanes.tracks[i] = cell->tracks;
+        lanes.groundwater[i] = cell->groundwater;
+        lanes.surfacewater[i] = cell->surfacewater;
+        lanes.humidityPreference[i] = cell->humidityPreference;
+        s64 vegetationCoverage = MAX((s64)cell->understory + (s64)cell->canopy, UINT32_MAX);
+        lanes.vegetationFactor[i] = ((double)vegetationCoverage / UINT32_MAX);
+        if (rates != NULL) {
+            u32 r = hydrologyRateIndex(rates, lanes.temperature[i], vegetationCoverage);
+            lanes.evaporationRate[i] = rates->evaporation[r];
+            lanes.infiltrationRate[i] = rates->infiltration[r];
+            lanes.transpirationRate[i] = rates->transpiration[r];
+        }
+    }
+
+    hydrologyKernel(&lanes, dT, rates != NULL);
+
+    for (int i = 0; i < HYDROLOGY_LANES; i++) {
+        CellData *cell = &cells[i];
+        cell->tracks = lanes.tracks[i];
+        cell->groundwater = lanes.groundwater[i];
+        cell->surfacewater = lanes.surfacewater[i];
+        cell->humidityPreference = lanes.humidityPreference[i];
+        // same as cellUpdate
+        if (lanes.vegetationChange[i] == VEGETATION_DIEOFF) {
+            s64 understory = cell->understory;
+            s64 canopy = cell->canopy;
+            understory *= 0.98;
+            canopy *= 0.98;
+            cell->understory = CLAMP(understory, 0, UINT32_MAX);
+            cell->canopy = CLAMP(canopy, 0, UINT32_MAX);
+        } else if (lanes.vegetationChange[i] == VEGETATION_GROW) {
+            s64 understory = cell->understory;
+            s64 canopy = cell->canopy;
+            understory += (0.01 * UINT32_MAX);
+            float canopyGrowth = plane_CanopyGrowthRate(plane, htw_geo_chunkAndCellToGridCoordinates(cm, chunkIndex, firstCell + i));
+            canopy += (canopyGrowth * 0.0005 * UINT32_MAX);
+            cell->understory = CLAMP(understory, 0, UINT32_MAX);
+            cell->canopy = CLAMP(canopy, 0, UINT32_MAX);
+        }
+    }
+}
+
+#endif // HYDROLOGY_LANES
+
 void chunkUpdate(Plane *plane, const Climate *climate, const size_t chunkIndex, const s64 dT) {
     htw_ChunkMap *cm = plane->chunkMap;
     CellData *base = cm->chunks[chunkIndex].cellData;
 
-    for (int c = 0; c < cm->cellsPerChunk; c++) {
-        CellData *cell = &base[c];
-        htw_geo_GridCoord cellCoord = htw_geo_chunkAndCellToGridCoordinates(cm, chunkIndex, c);
+    int c = 0;
+#ifdef HYDROLOGY_LANES
+    for (; c + HYDROLOGY_LANES <= cm->cellsPerChunk; c += HYDROLOGY_LANES) {
+        hydrologyUpdate(plane, climate, chunkIndex, c, &base[c], dT);
+    }
+#endif
+    // remainder, or every cell when built without SSE4.1 or AVX2
+    for (; c < cm->cellsPerChunk; c++) {
+        cellUpdate(plane, climate, chunkIndex, c, &base[c], dT);
+    }
+}
 
-        // don't need to do anything if cell is below sea level
-        if (cell->height < 0) {
-            cell->groundwater = 0;
-            cell->surfacewater = 0;
-            continue;
-        }
+/* Hydrology lane check
+ * bc_compareHydrologyLanes runs chunkUpdate and cellUpdate on two copies of the same randomized chunks, and checks every cell against the tolerance described above
+ */
 
-        s32 temp = plane_GetCellTemperature(plane, climate, cellCoord);
-        bool isGrowingSeason = temp > 0 && temp < 3000; // between 0 and 30 c; possibly too wide
+#define HYDROLOGY_WATER_TOLERANCE 2
+#define HYDROLOGY_TRACKS_TOLERANCE 1
 
-        // Expand celldata fields to avoid overflows
-        s64 tracks = cell->tracks;
-        s64 groundwater = cell->groundwater;
-        s64 surfacewater = cell->surfacewater;
-        s64 humidityPreference = cell->humidityPreference;
-        s64 understory = cell->understory;
-        s64 canopy = cell->canopy;
-
-        // erase tracks TODO: effect should scale with dT
-        tracks = MIN(tracks * 0.98, tracks - 1);
-
-        s64 vegetationCoverage = MAX(understory + canopy, UINT32_MAX);
-        s64 evaporation = evaporationPerHour(temp, vegetationCoverage) * dT;
-
-        // surface water enters the ground and evaporates
-        if (surfacewater > 0) {
-            s64 infiltration = infiltrationPerHour(temp, groundwater, vegetationCoverage) * dT;
-            s64 groundAvailableCapacity = INT16_MAX - groundwater;
-            s64 limit = MIN(surfacewater, groundAvailableCapacity); // can't transfer more than is available or more than destination can accept
-            infiltration = MIN(infiltration, limit);
-            // if groundwater in negative, start from 1 so frozen surface water doesn't 'dry out' the tile
-            groundwater = MAX(1, groundwater) + infiltration;
-            surfacewater -= evaporation + infiltration;
-        }
-
-        if (groundwater <= 0) {
-            // Track hours since water was available
-            groundwater -= dT;
-            // kill vegetation if dry longer than drought resistance threshold
-            if (-groundwater > (MAX_DROUGHT_TOLERANCE - humidityPreference)) {
-                // lower humidity preference
-                humidityPreference -= 1 * dT;
-                // TODO: dieoff should scale with dT
-                understory *= 0.98;
-                canopy *= 0.98;
-            }
-        } else if (isGrowingSeason) {
-            // raise humidity preference
-            humidityPreference += 1 * dT;
-            // Remove groundwater according to evapotranspiration
-            s64 transpiration = transpirationPerHour(temp, vegetationCoverage);
-            groundwater -= (evaporation + transpiration);
-            // grow new vegetation
-            // 100 days to reach full understory
-            understory += (0.01 * UINT32_MAX);
+// Fill every cell from most of each field's range, about a quarter of cells below sea level and half without surface water. Heights stay low enough that cells aren't all frozen
+static void randomizeHydrologyCells(htw_ChunkMap *cm, u32 seed) {
+    u32 chunkCount = cm->chunkCountX * cm->chunkCountY;
+    for (u32 c = 0; c < chunkCount; c++) {
+        CellData *cells = cm->chunks[c].cellData;
+        for (u32 i = 0; i < cm->cellsPerChunk; i++) {
+            u32 n = (c * cm->cellsPerChunk) + i;
+            memset(&cells[i], 0, sizeof(CellData));
+            cells[i].height = (s32)(xxh_hash2d(seed, n, 0) % 64) - 16;
+            cells[i].tracks = xxh_hash2d(seed, n, 1);
+            cells[i].groundwater = (s16)xxh_hash2d(seed, n, 2);
+            cells[i].surfacewater = xxh_hash2d(seed, n, 3) & 1 ? xxh_hash2d(seed, n, 4) : 0;
+            cells[i].humidityPreference = xxh_hash2d(seed, n, 5);
+            cells[i].understory = xxh_hash2d(seed, n, 6);
+            cells[i].canopy = xxh_hash2d(seed, n, 7);
+        }
+    }
+}
 
-            // should take ~100 years to reach full canopy, but numbers are less clear because of variable growth rate
-            // TODO: high tracks % should slow early canopy growth, very high tracks % should slow understory growth
-            float canopyGrowth = plane_CanopyGrowthRate(plane, cellCoord);
-            canopy += (canopyGrowth * 0.0005 * UINT32_MAX);
-        } else {
-            // dry weather outside of growing season doesn't effect humidity preference
-            // Remove groundwater according to evaporation TODO
-            groundwater -= evaporation;
+static void compareHydrologyCells(const htw_ChunkMap *lanesMap, const htw_ChunkMap *scalarMap, bc_HydrologyLaneReport *report) {
+    u32 chunkCount = lanesMap->chunkCountX * lanesMap->chunkCountY;
+    for (u32 c = 0; c < chunkCount; c++) {
+        const CellData *a = lanesMap->chunks[c].cellData;
+        const CellData *b = scalarMap->chunks[c].cellData;
+        for (u32 i = 0; i < lanesMap->cellsPerChunk; i++) {
+            s32 waterError = MAX(abs(a[i].groundwater - b[i].groundwater), abs(a[i].surfacewater - b[i].surfacewater));
+            s32 tracksError = abs(a[i].tracks - b[i].tracks);
+            report->maxWaterError = MAX(report->maxWaterError, waterError);
+            report->maxTracksError = MAX(report->maxTracksError, tracksError);
+            if (waterError > HYDROLOGY_WATER_TOLERANCE || tracksError > HYDROLOGY_TRACKS_TOLERANCE) {
+                report->failedCells++;
+            } else if (a[i].height != b[i].height ||
+                       a[i].humidityPreference != b[i].humidityPreference ||
+                       a[i].understory != b[i].understory ||
+                       a[i].canopy != b[i].canopy) {
+                report->failedCells++;
+            }
+            report->cellsCompared++;
         }
+    }
+}
 
-        // Clamp values before assigning back to cell
-        cell->tracks = CLAMP(tracks, 0, UINT16_MAX);
-        cell->groundwater = CLAMP(groundwater, INT16_MIN, INT16_MAX);
-        cell->surfacewater = CLAMP(surfacewater, 0, UINT16_MAX);
-        cell->humidityPreference = CLAMP(humidityPreference, 0, UINT16_MAX);
-        cell->understory = CLAMP(understory, 0, UINT32_MAX);
-        cell->canopy = CLAMP(canopy, 0, UINT32_MAX);
+bool bc_compareHydrologyLanes(u32 chunkCount, u32 seed, bc_HydrologyLaneReport *report) {
+#ifdef HYDROLOGY_LANES
+    *report = (bc_HydrologyLaneReport){.lanes = HYDROLOGY_LANES};
+#else
+    *report = (bc_HydrologyLaneReport){.lanes = 0};
+#endif
+    // Same as the Overworld in data/model/plecs/test.flecs; radial, so temperatures across the row of chunks span freezing to hot
+    Climate climate = {
+        .poleBiotemp = 4000,
+        .equatorBiotemp = -1500,
+        .tempChangePerElevationStep = -65,
+        .type = CLIMATE_TYPE_RADIAL,
+        .season = {.temperatureRange = 2000, .cycleLength = 24 * 360}
+    };
+    bc_HydrologyRates *rates = buildHydrologyRates(&climate, &(RateTableResolution){256, 256});
+    Plane lanesPlane = {.chunkMap = bc_createTerrain(32, MAX(1, chunkCount), 1)};
+    Plane scalarPlane = {.chunkMap = bc_createTerrain(32, MAX(1, chunkCount), 1)};
+    htw_ChunkMap *cm = scalarPlane.chunkMap;
+
+    const s64 deltas[] = {1, 24, 24 * CHUNK_LOD_MAX_INTERVAL};
+    const s32 seasonModifiers[] = {-2000, 0, 2000};
+    u32 run = 0;
+    for (int useRates = 0; useRates < 2; useRates++) {
+        lanesPlane.hydrologyRates = useRates ? rates : NULL;
+        scalarPlane.hydrologyRates = useRates ? rates : NULL;
+        for (int d = 0; d < sizeof(deltas) / sizeof(deltas[0]); d++) {
+            for (int s = 0; s < sizeof(seasonModifiers) / sizeof(seasonModifiers[0]); s++, run++) {
+                climate.season.temperatureModifier = seasonModifiers[s];
+                u32 runSeed = xxh_hash2d(seed, run, 0);
+                randomizeHydrologyCells(lanesPlane.chunkMap, runSeed);
+                randomizeHydrologyCells(scalarPlane.chunkMap, runSeed);
+                for (u32 c = 0; c < cm->chunkCountX * cm->chunkCountY; c++) {
+                    chunkUpdate(&lanesPlane, &climate, c, deltas[d]);
+                    CellData *cells = cm->chunks[c].cellData;
+                    for (u32 i = 0; i < cm->cellsPerChunk; i++) {
+                        cellUpdate(&scalarPlane, &climate, c, i, &cells[i], deltas[d]);
+                    }
+                }
+                compareHydrologyCells(lanesPlane.chunkMap, scalarPlane.chunkMap, report);
+            }
+        }
     }
+
+    bc_destroyTerrain(lanesPlane.chunkMap);
+    bc_destroyTerrain(scalarPlane.chunkMap);
+    freeHydrologyRates(rates);
+    return report->failedCells == 0;
 }
 
-void riverConnectionsUpdate(Plane *plane, size_t chunkIndex) {
+// Neighbors are read from halo, so every cell sees its neighbors as they were before this pass
+void riverConnectionsUpdate(Plane *plane, const bc_HaloChunkMap *halo, size_t chunkIndex) {
     htw_ChunkMap *cm = plane->chunkMap;
-    CellData *base = cm->chunks[chunkIndex].cellData;
+    htw_geo_GridCoord chunkRoot = htw_geo_chunkAndCellToGridCoordinates(cm, chunkIndex, 0);
 
-    for (int c = 0; c < cm->cellsPerChunk; c++) {
-        CellData *cell = &base[c];
-        htw_geo_GridCoord cellCoord = htw_geo_chunkAndCellToGridCoordinates(cm, chunkIndex, c);
+    bc_Stencil s = bc_stencilBegin(halo, cm, chunkIndex);
+    while (bc_stencilNext(&s)) {
+        CellData *cell = s.cell;
+        htw_geo_GridCoord cellCoord = htw_geo_addGridCoords(chunkRoot, (htw_geo_GridCoord){s.x, s.y});
 
         // don't make rivers under sea level
         if (cell->height < 0) {
@@ -153,8 +553,7 @@ void riverConnectionsUpdate(Plane *plane, size_t chunkIndex) {
             s32 lowest = cell->height;
             s32 lowestDir = -1;
             for (int d = 0; d < HEX_DIRECTION_COUNT; d++) {
-                htw_geo_GridCoord neighborCoord = POSITION_IN_DIRECTION(cellCoord, d);
-                CellData *neighborCell = htw_geo_getCell(cm, neighborCoord);
+                const CellData *neighborCell = bc_stencilNeighbor(&s, d);
                 if (neighborCell->height <= lowest) {
                     lowest = neighborCell->height;
                     lowestDir = d;
@@ -199,9 +598,9 @@ void riverConnectionsUpdate(Plane *plane, size_t chunkIndex) {
         } else if (cell->groundwater < (-180 * 24) && bc_hasAnyWaterways(cell->waterways)) {
             // If 2 neighboring cells dry for more than 6 months, remove river connection
             for (int d = 0; d < HEX_DIRECTION_COUNT; d++) {
-                htw_geo_GridCoord neighborCoord = POSITION_IN_DIRECTION(cellCoord, d);
-                CellData *neighborCell = htw_geo_getCell(cm, neighborCoord);
+                const CellData *neighborCell = bc_stencilNeighbor(&s, d);
                 if (neighborCell->groundwater < (-180 * 24) && bc_hasAnyWaterways(neighborCell->waterways)) {
+                    htw_geo_GridCoord neighborCoord = POSITION_IN_DIRECTION(cellCoord, d);
                     bc_removeRiverConnection(cm, cellCoord, neighborCoord);
                 }
             }
@@ -266,55 +665,561 @@ void riverUpdate(Plane *plane, size_t chunkIndex, s64 dT) {
     }
 }
 
+// Size of the river connection leaving a cell in direction, read the same way as extractCellWaterway
+static s32 waterwayConnection(CellWaterways waterways, HexDirection direction) {
+    u32 ww = *(u32*)&waterways;
+    return (ww >> (direction * 4)) & ((1 << 2) - 1);
+}
+
+// Volume that cell a would send to its neighbor b in direction in dT hours, before scaling for total outflow from a. 0 if b is the uphill side of the connection. Uses the same rules as riverUpdate, except flat connections with equal water pick one side by coordinate instead of by argument order, so both cells agree on which way water moves
+// Both cells are passed in, so b can come from a halo; the coordinate of a is only needed to break ties
+static s64 riverEdgeOutflow(const htw_ChunkMap *cm, const CellData *cellA, const CellData *cellB, htw_geo_GridCoord a, HexDirection direction, s64 dT) {
+    if (!bc_hasAnyWaterways(cellA->waterways) && !bc_hasAnyWaterways(cellB->waterways)) {
+        return 0;
+    }
+    // Same uphill side bc_riverConnectionFromCells would pick
+    if (cellB->height > cellA->height) {
+        return 0;
+    }
+    s32 slope = cellA->height - cellB->height;
+    // if no gradient, use side with higher total water as uphill
+    if (slope == 0) {
+        s64 totalA = cellA->groundwater + cellA->surfacewater;
+        s64 totalB = cellB->groundwater + cellB->surfacewater;
+        if (totalB > totalA) {
+            return 0;
+        } else if (totalB == totalA) {
+            htw_geo_GridCoord b = htw_geo_wrapGridCoordOnChunkMap(cm, POSITION_IN_DIRECTION(a, direction));
+            if (b.y < a.y || (b.y == a.y && b.x < a.x)) {
+                return 0;
+            }
+        }
+    }
+
+    // Connection out of a toward b, and out of b back toward a
+    s32 outSize = waterwayConnection(cellA->waterways, direction);
+    s32 inSize = waterwayConnection(cellB->waterways, htw_geo_hexDirectionOpposite(direction));
+    s32 inArea = inSize * inSize;
+    s32 outArea = outSize * outSize;
+    s64 volume = (float)(slope + 1) * (float)(inArea + outArea) * dT;
+    return MIN(volume, MAX(0, cellA->groundwater));
+}
+
+void riverComputeOutflows(const Plane *plane, const bc_HaloChunkMap *halo, size_t chunkIndex, s64 dT, u16 (*outflows)[HEX_DIRECTION_COUNT]) {
+    htw_ChunkMap *cm = plane->chunkMap;
+    htw_geo_GridCoord chunkRoot = htw_geo_chunkAndCellToGridCoordinates(cm, chunkIndex, 0);
+
+    bc_Stencil s = bc_stencilBegin(halo, cm, chunkIndex);
+    while (bc_stencilNext(&s)) {
+        const CellData *cell = s.center;
+        htw_geo_GridCoord cellCoord = htw_geo_addGridCoords(chunkRoot, (htw_geo_GridCoord){s.x, s.y});
+        u16 *cellOutflows = outflows[(chunkIndex * cm->cellsPerChunk) + s.cellIndex];
+
+        s64 volumes[HEX_DIRECTION_COUNT];
+        s64 totalVolume = 0;
+        for (int d = 0; d < HEX_DIRECTION_COUNT; d++) {
+            volumes[d] = riverEdgeOutflow(cm, cell, bc_stencilNeighbor(&s, d), cellCoord, d, dT);
+            totalVolume += volumes[d];
+        }
+
+        // can't transport more than is available, so share what there is between all downhill connections. Scaled volumes are never more than INT16_MAX
+        s64 available = MAX(0, cell->groundwater);
+        for (int d = 0; d < HEX_DIRECTION_COUNT; d++) {
+            cellOutflows[d] = totalVolume > available ? (volumes[d] * available) / totalVolume : volumes[d];
+        }
+    }
+}
+
+void riverApplyOutflows(Plane *plane, size_t chunkIndex, const u16 (*outflows)[HEX_DIRECTION_COUNT]) {
+    htw_ChunkMap *cm = plane->chunkMap;
+    CellData *base = cm->chunks[chunkIndex].cellData;
+
+    for (int c = 0; c < cm->cellsPerChunk; c++) {
+        CellData *cell = &base[c];
+        htw_geo_GridCoord cellCoord = htw_geo_chunkAndCellToGridCoordinates(cm, chunkIndex, c);
+        const u16 *cellOutflows = outflows[(chunkIndex * cm->cellsPerChunk) + c];
+
+        s64 outVolume = 0;
+        s64 inVolume = 0;
+        for (int d = 0; d < HEX_DIRECTION_COUNT; d++) {
+            outVolume += cellOutflows[d];
+            // neighbor's outflow toward this cell is in the opposite direction
+            htw_geo_GridCoord neighborCoord = POSITION_IN_DIRECTION(cellCoord, d);
+            u32 neighborChunk, neighborCell;
+            htw_geo_gridCoordinateToChunkAndCellIndex(cm, neighborCoord, &neighborChunk, &neighborCell);
+            inVolume += outflows[(neighborChunk * cm->cellsPerChunk) + neighborCell][htw_geo_hexDirectionOpposite(d)];
+        }
+
+        s64 groundwater = cell->groundwater;
+        // if some water coming in, reset dry days counter
+        groundwater = inVolume > 0 ? MAX(0, groundwater) : groundwater;
+        groundwater += inVolume - outVolume;
+        cell->groundwater = CLAMP(groundwater, INT16_MIN, INT16_MAX);
+    }
+}
+
+static void advanceSeason(Season *season, u32 hours) {
+    season->cycleProgress = (season->cycleProgress + hours) % season->cycleLength;
+    season->temperatureModifier =
+    sinf( ((float)season->cycleProgress * TAU) / season->cycleLength ) * season->temperatureRange;
+}
+
 void TickSeasons(ecs_iter_t *it) {
     Climate *climates = ecs_field(it, Climate, 1);
 
     for (int i = 0; i < it->count; i++) {
-        Season *season = &climates[i].season;
-        season->cycleProgress = (season->cycleProgress + 1) % season->cycleLength;
-        season->temperatureModifier =
-        sinf( ((float)season->cycleProgress * TAU) / season->cycleLength ) * season->temperatureRange;
+        advanceSeason(&climates[i].season, 1);
+    }
+}
+
+typedef struct {
+    Plane *plane;
+    const Climate *climate;
+    s64 dT;
+    u32 firstChunk;
+    bc_ChunkActivity *activity; // if NULL, every chunk is updated with dT
+    u64 step;
+    u32 distantInterval;
+} ChunkUpdateJob;
+
+static void chunkUpdateJob(void *ctx, u32 index) {
+    ChunkUpdateJob *job = ctx;
+    u32 chunkIndex = job->firstChunk + index;
+    if (!plane_IsChunkResident(job->plane, chunkIndex)) {
+        return;
+    }
+    bc_ChunkActivity *activity = job->activity;
+    if (activity == NULL) {
+        chunkUpdate(job->plane, job->climate, chunkIndex, job->dT);
+        return;
+    }
+
+    switch (activity->tiers[chunkIndex]) {
+        case CHUNK_ACTIVITY_SUBMERGED:
+            // Nothing to simulate, but don't let time pile up in case the chunk is raised later
+            activity->lastUpdateSteps[chunkIndex] = job->step;
+            return;
+        case CHUNK_ACTIVITY_DISTANT:
+            // Offset by chunk index so distant chunks are spread evenly across days
+            if (((job->step / 24) + chunkIndex) % job->distantInterval != 0) {
+                return;
+            }
+            break;
+        default:
+            break;
+    }
+    // Covers every day since the last update, including days missed while distant
+    s64 dT = MIN(job->step - activity->lastUpdateSteps[chunkIndex], 24 * CHUNK_LOD_MAX_INTERVAL);
+    activity->lastUpdateSteps[chunkIndex] = job->step;
+    if (dT > 0) {
+        chunkUpdate(job->plane, job->climate, chunkIndex, dT);
+    }
+}
+
+static bool chunkIsSubmerged(const htw_ChunkMap *cm, u32 chunkIndex) {
+    const CellData *cells = cm->chunks[chunkIndex].cellData;
+    for (u32 c = 0; c < cm->cellsPerChunk; c++) {
+        if (cells[c].height >= 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Every step, before anything reads cells: make chunks around every actor on a lazily generated plane resident, generating them if needed. Uses the same radius as MarkActiveChunks
+void LoadResidentChunks(ecs_iter_t *it) {
+    Position *positions = ecs_field(it, Position, 1);
+    Plane *plane = ecs_field(it, Plane, 2); // constant for each table
+    MapVision *vis = ecs_field_is_set(it, 3) ? ecs_field(it, MapVision, 3) : NULL;
+    const ChunkLod *lod = ecs_field_is_set(it, 4) ? ecs_field(it, ChunkLod, 4) : NULL;
+    bc_JobPool *pool = ecs_field_is_set(it, 5) ? ecs_field(it, JobPool, 5)->pool : NULL;
+    if (plane->lazyChunks == NULL) {
+        return;
+    }
+    htw_ChunkMap *cm = plane->chunkMap;
+
+    for (int i = 0; i < it->count; i++) {
+        u32 radius = lod == NULL ? 1 : lod->activeRadius;
+        if (vis != NULL) {
+            radius += (vis[i].range + cm->chunkSize - 1) / cm->chunkSize;
+        }
+        bc_makeChunksResident(plane, positions[i], radius, pool);
+    }
+}
+
+// Once a day, before MarkActiveChunks: every chunk starts out distant, or submerged if all below sea level
+void ClassifyChunkActivity(ecs_iter_t *it) {
+    Plane *planes = ecs_field(it, Plane, 1);
+    const ChunkLod *lod = ecs_field_is_set(it, 2) ? ecs_field(it, ChunkLod, 2) : NULL;
+    Step step = *ecs_singleton_get(it->world, Step);
+
+    for (int i = 0; i < it->count; i++) {
+        htw_ChunkMap *cm = planes[i].chunkMap;
+        bc_ChunkActivity *activity = plane_GetChunkActivity(&planes[i], step);
+        for (u32 c = 0; c < activity->chunkCount; c++) {
+            if (lod == NULL) {
+                activity->tiers[c] = CHUNK_ACTIVITY_ACTIVE;
+            } else if (lod->skipSubmerged && chunkIsSubmerged(cm, c)) {
+                activity->tiers[c] = CHUNK_ACTIVITY_SUBMERGED;
+            } else {
+                activity->tiers[c] = CHUNK_ACTIVITY_DISTANT;
+            }
+        }
+    }
+}
+
+// Raise distant chunks around every actor to active. Submerged chunks stay skipped even with an actor nearby
+void MarkActiveChunks(ecs_iter_t *it) {
+    Position *positions = ecs_field(it, Position, 1);
+    Plane *plane = ecs_field(it, Plane, 2); // constant for each table
+    MapVision *vis = ecs_field_is_set(it, 3) ? ecs_field(it, MapVision, 3) : NULL;
+    const ChunkLod *lod = ecs_field_is_set(it, 4) ? ecs_field(it, ChunkLod, 4) : NULL;
+    bc_ChunkActivity *activity = plane->activity;
+    if (lod == NULL || activity == NULL) {
+        return;
+    }
+    htw_ChunkMap *cm = plane->chunkMap;
+    // Wider than this would only revisit the same chunks
+    s32 maxRadius = MAX(cm->chunkCountX, cm->chunkCountY) / 2;
+
+    for (int i = 0; i < it->count; i++) {
+        u32 radius = lod->activeRadius;
+        if (vis != NULL) {
+            radius += (vis[i].range + cm->chunkSize - 1) / cm->chunkSize;
+        }
+        s32 r = MIN((s32)radius, maxRadius);
+        u32 chunkIndex, cellIndex;
+        htw_geo_gridCoordinateToChunkAndCellIndex(cm, positions[i], &chunkIndex, &cellIndex);
+        for (s32 y = -r; y <= r; y++) {
+            for (s32 x = -r; x <= r; x++) {
+                u32 neighbor = htw_geo_getChunkIndexAtOffset(cm, chunkIndex, (htw_geo_GridCoord){x, y});
+                if (activity->tiers[neighbor] == CHUNK_ACTIVITY_DISTANT) {
+                    activity->tiers[neighbor] = CHUNK_ACTIVITY_ACTIVE;
+                }
+            }
+        }
+    }
+}
+
+// Builds each plane's biotemperature cache on the first step, and rebuilds it after any change to the plane's climate or after it's invalidated by a whole-map height pass. Other height changes update single cells where they happen
+void RefreshBiotemperature(ecs_iter_t *it) {
+    Plane *planes = ecs_field(it, Plane, 1);
+    Climate *climates = ecs_field(it, Climate, 2);
+
+    for (int i = 0; i < it->count; i++) {
+        plane_RefreshBiotemperature(&planes[i], &climates[i]);
+    }
+}
+
+static void refreshHydrologyRates(Plane *plane, const Climate *climate, const RateTableResolution *resolution) {
+    bool enabled = resolution != NULL && resolution->temperatureBuckets > 0 && resolution->vegetationBuckets > 0;
+    bc_HydrologyRates *rates = plane->hydrologyRates;
+    if (!enabled) {
+        freeHydrologyRates(rates);
+        plane->hydrologyRates = NULL;
+    } else if (rates == NULL || !hydrologyRatesMatch(rates, climate, resolution)) {
+        freeHydrologyRates(rates);
+        plane->hydrologyRates = buildHydrologyRates(climate, resolution);
+    }
+}
+
+// Builds each plane's hydrology rate tables on the first step, and rebuilds them after any change to the plane's climate or the table resolution
+void RefreshHydrologyRates(ecs_iter_t *it) {
+    Plane *planes = ecs_field(it, Plane, 1);
+    Climate *climates = ecs_field(it, Climate, 2);
+    const RateTableResolution *resolution = ecs_field_is_set(it, 3) ? ecs_field(it, RateTableResolution, 3) : NULL;
+
+    for (int i = 0; i < it->count; i++) {
+        refreshHydrologyRates(&planes[i], &climates[i], resolution);
     }
 }
 
 void TerrainDailyStep(ecs_iter_t *it) {
     Plane *planes = ecs_field(it, Plane, 1);
     Climate *climates = ecs_field(it, Climate, 2);
+    bc_JobPool *pool = ecs_field_is_set(it, 3) ? ecs_field(it, JobPool, 3)->pool : NULL;
+    const ChunkLod *lod = ecs_field_is_set(it, 4) ? ecs_field(it, ChunkLod, 4) : NULL;
+    u32 distantInterval = lod == NULL ? 1 : CLAMP(lod->distantInterval, 1, CHUNK_LOD_MAX_INTERVAL);
+    Step step = *ecs_singleton_get(it->world, Step);
 
     for (int i = 0; i < it->count; i++) {
         htw_ChunkMap *cm = planes[i].chunkMap;
-        for (int c = 0, y = 0; y < cm->chunkCountY; y++) {
-            for (int x = 0; x < cm->chunkCountX; x++, c++) {
-                chunkUpdate(&planes[i], &climates[i], c, 24);
+        // chunkUpdate only touches cells in its own chunk, so the result doesn't depend on which thread runs which chunk
+        u32 begin, end;
+        bc_amortizedRange(it, cm->chunkCountX * cm->chunkCountY, &begin, &end);
+        ChunkUpdateJob job = {
+            .plane = &planes[i],
+            .climate = &climates[i],
+            .dT = 24,
+            .firstChunk = begin,
+            .activity = planes[i].activity,
+            .step = step,
+            .distantInterval = distantInterval
+        };
+        bc_parallelFor(pool, end - begin, chunkUpdateJob, &job);
+    }
+}
+
+/* River scratch
+ * FormRivers and FlowRivers run on a slice of chunks every step while amortized, so their whole-map buffers are allocated once per plane instead of every run. outflows is all zeros between runs: flowRivers clears the chunks it computed once their outflows are applied, so a partial run only has to touch its own slice and the chunks next to it
+ */
+
+struct bc_RiverScratch {
+    u32 chunkCount;
+    u32 cellsPerChunk;
+    bc_HaloChunkMap *halo; // NULL until rivers first form or flow
+    u16 (*outflows)[HEX_DIRECTION_COUNT]; // per cell, indexed by (chunkIndex * cellsPerChunk) + cellIndex
+    u32 *applyChunks; // room for every chunk
+    bool *includedChunks; // per chunk, all false between runs
+};
+
+static void freeRiverScratch(bc_RiverScratch *scratch) {
+    if (scratch == NULL) {
+        return;
+    }
+    bc_destroyHaloChunkMap(scratch->halo);
+    free(scratch->outflows);
+    free(scratch->applyChunks);
+    free(scratch->includedChunks);
+    free(scratch);
+}
+
+static bc_RiverScratch *getRiverScratch(Plane *plane) {
+    htw_ChunkMap *cm = plane->chunkMap;
+    u32 chunkCount = cm->chunkCountX * cm->chunkCountY;
+    bc_RiverScratch *scratch = plane->riverScratch;
+    if (scratch != NULL && scratch->chunkCount == chunkCount && scratch->cellsPerChunk == cm->cellsPerChunk) {
+        return scratch;
+    }
+    freeRiverScratch(scratch);
+    scratch = malloc(sizeof(bc_RiverScratch));
+    *scratch = (bc_RiverScratch){
+        .chunkCount = chunkCount,
+        .cellsPerChunk = cm->cellsPerChunk,
+        .halo = NULL,
+        .outflows = calloc((size_t)chunkCount * cm->cellsPerChunk, sizeof(u16[HEX_DIRECTION_COUNT])),
+        .applyChunks = malloc(chunkCount * sizeof(u32)),
+        .includedChunks = calloc(chunkCount, sizeof(bool)),
+    };
+    plane->riverScratch = scratch;
+    return scratch;
+}
+
+// Update river connections of chunks in [begin, end)
+static void formRivers(Plane *plane, bc_JobPool *pool, u32 begin, u32 end) {
+    htw_ChunkMap *cm = plane->chunkMap;
+    bc_RiverScratch *scratch = getRiverScratch(plane);
+    if (scratch->halo == NULL) {
+        scratch->halo = bc_createHaloChunkMap(cm);
+    }
+    bc_HaloChunkMap *halo = scratch->halo;
+    // Only the blocks of resident chunks in the slice are read below, so the rest of the halo can stay stale
+    if (plane->lazyChunks == NULL && begin == 0 && end == halo->chunkCount) {
+        bc_refreshHaloChunkMap(halo, cm, pool);
+    } else {
+        for (u32 c = begin; c < end; c++) {
+            if (plane_IsChunkResident(plane, c)) {
+                bc_refreshHaloChunk(halo, cm, c);
             }
         }
     }
+    // Connections change cells on both sides, so chunks can't be updated in parallel
+    for (u32 c = begin; c < end; c++) {
+        if (plane_IsChunkResident(plane, c)) {
+            riverConnectionsUpdate(plane, halo, c);
+        }
+    }
 }
 
 void FormRivers(ecs_iter_t *it) {
     Plane *planes = ecs_field(it, Plane, 1);
+    bc_JobPool *pool = ecs_field_is_set(it, 2) ? ecs_field(it, JobPool, 2)->pool : NULL;
 
     for (int i = 0; i < it->count; i++) {
         htw_ChunkMap *cm = planes[i].chunkMap;
-        for (int c = 0, y = 0; y < cm->chunkCountY; y++) {
-            for (int x = 0; x < cm->chunkCountX; x++, c++) {
-                riverConnectionsUpdate(&planes[i], c);
+        u32 begin, end;
+        bc_amortizedRange(it, cm->chunkCountX * cm->chunkCountY, &begin, &end);
+        formRivers(&planes[i], pool, begin, end);
+    }
+}
+
+typedef struct {
+    Plane *plane;
+    bc_HaloChunkMap *halo; // refreshed for each chunk right before its outflows are computed
+    s64 dT;
+    u16 (*outflows)[HEX_DIRECTION_COUNT];
+    u32 firstChunk; // outflows are computed for chunks starting here
+    const u32 *applyChunks; // chunks to apply outflows to; if NULL, the same chunks outflows were computed for
+} RiverFlowJob;
+
+static void riverComputeOutflowsJob(void *ctx, u32 index) {
+    RiverFlowJob *job = ctx;
+    u32 chunkIndex = job->firstChunk + index;
+    // Scratch is already zeroed, so non-resident chunks have no outflows; water can still flow in from resident neighbors
+    if (plane_IsChunkResident(job->plane, chunkIndex)) {
+        // Only this chunk's block is written, and cells don't change until every outflow is computed
+        bc_refreshHaloChunk(job->halo, job->plane->chunkMap, chunkIndex);
+        riverComputeOutflows(job->plane, job->halo, chunkIndex, job->dT, job->outflows);
+    }
+}
+
+static void riverApplyOutflowsJob(void *ctx, u32 index) {
+    RiverFlowJob *job = ctx;
+    u32 chunkIndex = job->applyChunks == NULL ? job->firstChunk + index : job->applyChunks[index];
+    riverApplyOutflows(job->plane, chunkIndex, (const u16 (*)[HEX_DIRECTION_COUNT])job->outflows);
+}
+
+// Chunks in [begin, end) and every chunk next to them, without duplicates. Returns number of chunks written to outChunks, which must have room for every chunk in cm. included must be all false, and is left that way
+static u32 chunksWithNeighbors(const htw_ChunkMap *cm, u32 begin, u32 end, u32 *outChunks, bool *included) {
+    u32 count = 0;
+    for (u32 c = begin; c < end; c++) {
+        for (s32 y = -1; y <= 1; y++) {
+            for (s32 x = -1; x <= 1; x++) {
+                u32 neighbor = htw_geo_getChunkIndexAtOffset(cm, c, (htw_geo_GridCoord){x, y});
+                if (!included[neighbor]) {
+                    included[neighbor] = true;
+                    outChunks[count++] = neighbor;
+                }
+            }
+        }
+    }
+    for (u32 i = 0; i < count; i++) {
+        included[outChunks[i]] = false;
+    }
+    return count;
+}
+
+// Move water out of chunks in [begin, end) along rivers, over dT hours
+static void flowRivers(Plane *plane, RiverSolver solver, bc_JobPool *pool, u32 begin, u32 end, s64 dT) {
+    htw_ChunkMap *cm = plane->chunkMap;
+    u32 chunkCount = cm->chunkCountX * cm->chunkCountY;
+    if (solver == RIVER_SOLVER_LEGACY) {
+        for (u32 c = begin; c < end; c++) {
+            if (plane_IsChunkResident(plane, c)) {
+                riverUpdate(plane, c, dT);
             }
         }
+        return;
     }
+
+    // Every cell's outflows are computed before any are applied, so each phase can run chunks in any order
+    bc_RiverScratch *scratch = getRiverScratch(plane);
+    if (scratch->halo == NULL) {
+        scratch->halo = bc_createHaloChunkMap(cm);
+    }
+    RiverFlowJob job = {
+        .plane = plane,
+        .halo = scratch->halo,
+        .dT = dT,
+        .outflows = scratch->outflows,
+        .firstChunk = begin,
+        .applyChunks = NULL
+    };
+    u32 applyCount = end - begin;
+    if (applyCount != chunkCount) {
+        // Only some chunks flow this step; all other outflows are 0, but water still flows into the chunks around them
+        applyCount = chunksWithNeighbors(cm, begin, end, scratch->applyChunks, scratch->includedChunks);
+        job.applyChunks = scratch->applyChunks;
+    }
+    bc_parallelFor(pool, end - begin, riverComputeOutflowsJob, &job);
+    bc_parallelFor(pool, applyCount, riverApplyOutflowsJob, &job);
+    // Chunks in the slice are contiguous in scratch
+    memset(scratch->outflows[(size_t)begin * cm->cellsPerChunk], 0, sizeof(u16[HEX_DIRECTION_COUNT]) * (end - begin) * cm->cellsPerChunk);
 }
 
 void FlowRivers(ecs_iter_t *it) {
     Plane *planes = ecs_field(it, Plane, 1);
+    RiverSolver solver = ecs_field_is_set(it, 2) ? *ecs_field(it, RiverSolver, 2) : RIVER_SOLVER_PARALLEL;
+    bc_JobPool *pool = ecs_field_is_set(it, 3) ? ecs_field(it, JobPool, 3)->pool : NULL;
 
     for (int i = 0; i < it->count; i++) {
         htw_ChunkMap *cm = planes[i].chunkMap;
-        for (int c = 0, y = 0; y < cm->chunkCountY; y++) {
-            for (int x = 0; x < cm->chunkCountX; x++, c++) {
-                riverUpdate(&planes[i], c, 24);
+        u32 begin, end;
+        bc_amortizedRange(it, cm->chunkCountX * cm->chunkCountY, &begin, &end);
+        flowRivers(&planes[i], solver, pool, begin, end, 24);
+    }
+}
+
+u64 bc_fastForwardTerrain(ecs_world_t *world, u32 years, u32 daysPerUpdate, bc_FastForwardProgress progress, void *progressCtx) {
+    const JobPool *jobs = ecs_singleton_get(world, JobPool);
+    bc_JobPool *pool = jobs == NULL ? NULL : jobs->pool;
+    const RiverSolver *solverSingleton = ecs_singleton_get(world, RiverSolver);
+    RiverSolver solver = solverSingleton == NULL ? RIVER_SOLVER_PARALLEL : *solverSingleton;
+    const RateTableResolution *resolution = ecs_singleton_get(world, RateTableResolution);
+    if (daysPerUpdate < 1 || daysPerUpdate > CHUNK_LOD_MAX_INTERVAL) {
+        // Longer updates would let water and vegetation changes overflow the per-cell math
+        ecs_warn("Fast forward days per update must be from 1 to %i, using %i instead of %u", CHUNK_LOD_MAX_INTERVAL, CLAMP(daysPerUpdate, 1, CHUNK_LOD_MAX_INTERVAL), daysPerUpdate);
+    }
+    s64 dT = 24 * CLAMP(daysPerUpdate, 1, CHUNK_LOD_MAX_INTERVAL);
+    u64 totalHours = (u64)years * HOURS_PER_YEAR;
+
+    // Nothing is added or removed from here on, so component pointers stay valid for the whole loop
+    ecs_query_t *planeQuery = ecs_query(world, {
+        .filter.terms = {
+            {.id = ecs_id(Plane), .inout = EcsInOut},
+            {.id = ecs_id(Climate), .inout = EcsInOut}
+        }
+    });
+    u32 planeCount = 0;
+    Plane **planes = NULL;
+    Climate **climates = NULL;
+    ecs_iter_t pit = ecs_query_iter(world, planeQuery);
+    while (ecs_query_next(&pit)) {
+        Plane *p = ecs_field(&pit, Plane, 1);
+        Climate *c = ecs_field(&pit, Climate, 2);
+        planes = realloc(planes, (planeCount + pit.count) * sizeof(Plane*));
+        climates = realloc(climates, (planeCount + pit.count) * sizeof(Climate*));
+        for (int i = 0; i < pit.count; i++, planeCount++) {
+            planes[planeCount] = &p[i];
+            climates[planeCount] = &c[i];
+            plane_RefreshBiotemperature(&p[i], &c[i]);
+            refreshHydrologyRates(&p[i], &c[i], resolution);
+            // Every chunk gets every update; activity is rebuilt on the next day after fast forwarding
+            plane_FreeChunkActivity(p[i].activity);
+            p[i].activity = NULL;
+        }
+    }
+
+    u64 hours = 0;
+    u64 hoursSinceRivers = 0;
+    while (hours < totalHours) {
+        s64 updateHours = MIN(dT, totalHours - hours);
+        for (u32 p = 0; p < planeCount; p++) {
+            htw_ChunkMap *cm = planes[p]->chunkMap;
+            u32 chunkCount = cm->chunkCountX * cm->chunkCountY;
+            advanceSeason(&climates[p]->season, updateHours);
+            ChunkUpdateJob job = {
+                .plane = planes[p],
+                .climate = climates[p],
+                .dT = updateHours,
+                .firstChunk = 0,
+                .activity = NULL
+            };
+            bc_parallelFor(pool, chunkCount, chunkUpdateJob, &job);
+            flowRivers(planes[p], solver, pool, 0, chunkCount, updateHours);
+        }
+        hours += updateHours;
+        hoursSinceRivers += updateHours;
+        if (hoursSinceRivers >= HOURS_PER_MONTH) {
+            hoursSinceRivers -= HOURS_PER_MONTH;
+            for (u32 p = 0; p < planeCount; p++) {
+                htw_ChunkMap *cm = planes[p]->chunkMap;
+                formRivers(planes[p], pool, 0, cm->chunkCountX * cm->chunkCountY);
             }
         }
+        if (progress != NULL) {
+            progress(hours, totalHours, progressCtx);
+        }
     }
+
+    free(planes);
+    free(climates);
+    ecs_query_fini(planeQuery);
+
+    // Keep the calendar in line with the terrain's age
+    Step step = *ecs_singleton_get(world, Step);
+    ecs_singleton_set(world, Step, {step + hours});
+    return hours;
 }
 
 void CleanEmptyRoots(ecs_iter_t *it) {
@@ -335,26 +1240,66 @@ void CleanEmptyRoots(ecs_iter_t *it) {
 void BcSystemsTerrainImport(ecs_world_t *world) {
     ECS_MODULE(world, BcSystemsTerrain);
 
+    ECS_IMPORT(world, BcCommon);
     ECS_IMPORT(world, BcPhases);
     ECS_IMPORT(world, BcPlanes);
+    ECS_IMPORT(world, BcActors);
+
+    ECS_SYSTEM(world, LoadResidentChunks, Prep,
+        [in] Position,
+        [inout] Plane(up(bc.planes.IsIn)),
+        [in] ?MapVision,
+        [in] ?ChunkLod($),
+        [in] ?JobPool($)
+    );
+
+    ECS_SYSTEM(world, RefreshBiotemperature, Prep,
+        [inout] Plane,
+        [in] Climate
+    );
+
+    ECS_SYSTEM(world, RefreshHydrologyRates, Prep,
+        [inout] Plane,
+        [in] Climate,
+        [in] ?RateTableResolution($)
+    );
+
+    ECS_SYSTEM(world, ClassifyChunkActivity, Prep,
+        [inout] Plane,
+        [in] ?ChunkLod($)
+    );
+    ecs_set_tick_source(world, ClassifyChunkActivity, TickDay);
+
+    ECS_SYSTEM(world, MarkActiveChunks, Prep,
+        [in] Position,
+        [inout] Plane(up(bc.planes.IsIn)),
+        [in] ?MapVision,
+        [in] ?ChunkLod($)
+    );
+    ecs_set_tick_source(world, MarkActiveChunks, TickDay);
 
     ECS_SYSTEM(world, TickSeasons, AdvanceStep, [inout] Climate);
 
     ECS_SYSTEM(world, TerrainDailyStep, AdvanceStep,
         [inout] Plane,
-        [in] Climate
+        [in] Climate,
+        [in] ?JobPool($),
+        [in] ?ChunkLod($)
     );
-    ecs_set_tick_source(world, TerrainDailyStep, TickDay);
+    bc_setAmortizedSystem(world, TerrainDailyStep, TickDay, 24);
 
     ECS_SYSTEM(world, FormRivers, AdvanceStep,
         [inout] Plane,
+        [in] ?JobPool($)
     );
-    ecs_set_tick_source(world, FormRivers, TickMonth);
+    bc_setAmortizedSystem(world, FormRivers, TickMonth, HOURS_PER_MONTH);
 
     ECS_SYSTEM(world, FlowRivers, AdvanceStep,
         [inout] Plane,
+        [in] ?RiverSolver($),
+        [in] ?JobPool($)
     );
-    ecs_set_tick_source(world, FlowRivers, TickDay);
+    bc_setAmortizedSystem(world, FlowRivers, TickDay, 24);
 
     ECS_SYSTEM(world, CleanEmptyRoots, Cleanup, bc.planes.CellRoot);
 }
@@ -1,8 +1,42 @@
 #ifndef BASALTIC_TERRAIN_SYSTEMS_H_INCLUDED
 #define BASALTIC_TERRAIN_SYSTEMS_H_INCLUDED
 
+#include "htw_core.h"
 #include "flecs.h"
 
 void BcSystemsTerrainImport(ecs_world_t *world);
 
+/// Called after every fast forward update with the number of hours simulated so far
+typedef void (*bc_FastForwardProgress)(u64 hoursDone, u64 hoursTotal, void *ctx);
+
+/**
+ * @brief Age the terrain of every plane with a Climate by years, without running the pipeline. Only seasons, hydrology (as in TerrainDailyStep), and rivers (as in FlowRivers and FormRivers) are updated, directly in a tight loop with daysPerUpdate days per update; actors, elementals, observers, and every other system are skipped. Chunk activity tiers and amortized scheduling are ignored, so every chunk gets every update. Advances the Step singleton by the number of hours simulated. Must not be called while the world is progressing
+ *
+ * @param world model world
+ * @param years model years (12 months of 4 weeks) to simulate
+ * @param daysPerUpdate dT of each update in days, clamped to [1, CHUNK_LOD_MAX_INTERVAL] with a warning if outside
+ * @param progress if not NULL, called after every update
+ * @param progressCtx passed to progress
+ * @return number of hours simulated
+ */
+u64 bc_fastForwardTerrain(ecs_world_t *world, u32 years, u32 daysPerUpdate, bc_FastForwardProgress progress, void *progressCtx);
+
+typedef struct {
+    u32 lanes; // cells per SIMD hydrology update, 0 if built without SSE4.1 or AVX2
+    u64 cellsCompared;
+    s32 maxWaterError; // largest difference in groundwater or surfacewater
+    s32 maxTracksError;
+    u64 failedCells; // cells outside tolerance, or with any other field different
+} bc_HydrologyLaneReport;
+
+/**
+ * @brief Run the daily hydrology update on a row of randomized chunks twice, once through the SIMD path used by the simulation and once through the scalar per-cell reference, and compare every cell. Covers several dT, seasons, and both with and without hydrology rate tables. Needs no world
+ *
+ * @param chunkCount number of 32 x 32 chunks to compare
+ * @param seed selects cell values
+ * @param report filled with the lane count and largest differences found
+ * @return true if groundwater and surfacewater are within 2, tracks within 1, and every other field matches exactly in every cell
+ */
+bool bc_compareHydrologyLanes(u32 chunkCount, u32 seed, bc_HydrologyLaneReport *report);
+
 #endif // BASALTIC_TERRAIN_SYSTEMS_H_INCLUDED
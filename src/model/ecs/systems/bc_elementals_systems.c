@@ -41,7 +41,8 @@ htw_geo_GridCoord hexOnLine(htw_geo_GridCoord a, htw_geo_GridCoord b, s32 dist)
     return htw_geo_hexFractionalToHexCoord(q, r);
 }
 
-void shiftTerrainInLine(htw_ChunkMap *cm, htw_geo_GridCoord start, htw_geo_GridCoord towards, s32 baseline, s32 strength, float falloff) {
+void shiftTerrainInLine(const Plane *plane, htw_geo_GridCoord start, htw_geo_GridCoord towards, s32 baseline, s32 strength, float falloff) {
+    htw_ChunkMap *cm = plane->chunkMap;
     falloff = fmaxf(falloff, 1.0);
     s32 strengthPool = (strength * strength) / falloff;
 
@@ -65,13 +66,15 @@ void shiftTerrainInLine(htw_ChunkMap *cm, htw_geo_GridCoord start, htw_geo_GridC
         s32 expendedStrength = strength > 0 ? ceil(usableStrength * limitFactor) : floor(usableStrength * limitFactor);
         s32 unclampedHeight = expendedStrength + cell->height;
         cell->height = CLAMP(unclampedHeight, INT8_MIN, INT8_MAX);
+        plane_UpdateCellBiotemperature(plane, lineCoord);
         // only subtract as much strength as was used
         strengthPool -= abs(expendedStrength);
         i++;
     }
 }
 
-void landslideParticle(htw_ChunkMap *cm, htw_geo_GridCoord start) {
+void landslideParticle(const Plane *plane, htw_geo_GridCoord start) {
+    htw_ChunkMap *cm = plane->chunkMap;
     htw_geo_GridCoord pos = start;
 
     // Get all cells around current position
@@ -106,6 +109,7 @@ void landslideParticle(htw_ChunkMap *cm, htw_geo_GridCoord start) {
 
     CellData *cell = htw_geo_getCell(cm, pos);
     cell->height += 1;
+    plane_UpdateCellBiotemperature(plane, pos);
 
     //htw_geo_GridCoord forward = POSITION_IN_DIRECTION(pos, radToHexDir(angle));
 }
@@ -120,10 +124,11 @@ void EgoBehaviorTectonic(ecs_iter_t *it) {
         // alternate between moving and shifting
         if (step % 2) {
             // move in similar direction
-            if (htw_coinFlip()) {
+            bc_RandomStream rs = bc_randomStream(it, bc_actorKey(it->world, it->entities[i]));
+            if (bc_coinFlip(&rs)) {
                 angle[i] += PI/180.0;
             }
-            dest[i] = POSITION_IN_DIRECTION(pos[i], radToHexDir(angle[i] + htw_coinFlip()));
+            dest[i] = POSITION_IN_DIRECTION(pos[i], radToHexDir(angle[i] + bc_coinFlip(&rs)));
             ecs_add_pair(it->world, it->entities[i], Action, ActionMove);
         } else {
             ecs_add_pair(it->world, it->entities[i], Action, ActionShiftPlates);
@@ -157,6 +162,14 @@ void EgoBehaviorStorm(ecs_iter_t *it) {
     }
 }
 
+/// Equivalent to htw_rtd(1, sides), but doesn't touch the shared global RNG state; safe to use from worker threads
+static s32 stormRoll(ecs_entity_t storm, Step step, s32 sides) {
+    if (sides <= 0) {
+        return 0;
+    }
+    return (xxh_hash2d(storm, step, step >> 32) % sides) + 1;
+}
+
 void PrepStorm(ecs_iter_t *it) {
     Position *positions = ecs_field(it, Position, 1);
     Destination *destinations = ecs_field(it, Destination, 2);
@@ -166,6 +179,7 @@ void PrepStorm(ecs_iter_t *it) {
     Plane *plane = ecs_field(it, Plane, 5);
     htw_ChunkMap *cm = plane->chunkMap;
     Climate *climate = ecs_field(it, Climate, 6);
+    Step step = *ecs_field(it, Step, 7);
 
     for (int i = 0; i < it->count; i++) {
         Position pos = positions[i];
@@ -195,11 +209,10 @@ void PrepStorm(ecs_iter_t *it) {
                 htw_geo_GridCoord worldCoord = htw_geo_addGridCoords(pos, gridCoord);
                 CellData *c = htw_geo_getCell(cm, worldCoord);
                 // give 1% spirit power to cell as surfacewater
-                s64 surfacewater = c->surfacewater;
                 s32 rainfall = MAX(1, sp->value * 0.01);
-                surfacewater += rainfall * 5;
                 sp->value -= rainfall;
-                c->surfacewater = MIN(surfacewater, UINT16_MAX);
+                // storm areas can overlap, other storms may be raining on this cell from another thread
+                bc_cellAddSurfacewater(c, rainfall * 5);
                 if (sp->value < 0) {
                     break;
                 }
@@ -211,7 +224,7 @@ void PrepStorm(ecs_iter_t *it) {
             s32 dc = storm->maxDuration - storm->currentDuration;
             // 5% increased difficulty per unit of slope
             dc += slope * storm->maxDuration * 0.05;
-            s32 roll = htw_rtd(1, storm->maxDuration, NULL);
+            s32 roll = stormRoll(it->entities[i], step, storm->maxDuration);
             if (roll >= dc || sp->value <= 0) {
                 storm->isStorming = false;
                 storm->currentDuration = 0;
@@ -227,7 +240,7 @@ void PrepStorm(ecs_iter_t *it) {
             // up to 100% increased difficulty depending on available power
             dc += ((float)(storm->maxDuration * sp->value) / sp->maxValue);
             //dc += sp->value < sp->maxValue ? storm->maxDuration * 0.5 : 0;
-            s32 roll = htw_rtd(1, storm->maxDuration, NULL);
+            s32 roll = stormRoll(it->entities[i], step, storm->maxDuration);
             if (roll >= dc) {
                 storm->isStorming = true;
                 storm->currentDuration = 0;
@@ -280,12 +293,12 @@ void ExecuteShiftPlates(ecs_iter_t *it) {
         // Left side
         htw_geo_GridCoord startLeft = positions[i];
         htw_geo_GridCoord endLeft = hexLineEndPoint(startLeft, 20.0, angle[i] + (PI/2.0));
-        shiftTerrainInLine(cm, startLeft, endLeft, elevation[i], shiftStrength[i].left * strengthFactor, shiftStrength[i].falloff);
+        shiftTerrainInLine(plane, startLeft, endLeft, elevation[i], shiftStrength[i].left * strengthFactor, shiftStrength[i].falloff);
 
         // Right side (forward turned 60 deg CW)
         htw_geo_GridCoord startRight = POSITION_IN_DIRECTION(positions[i], radToHexDir(angle[i] - (PI/3.0)));
         htw_geo_GridCoord endRight = hexLineEndPoint(startRight, 20.0, angle[i] - (PI/2.0));
-        shiftTerrainInLine(cm, startRight, endRight, elevation[i], shiftStrength[i].right * strengthFactor, shiftStrength[i].falloff);
+        shiftTerrainInLine(plane, startRight, endRight, elevation[i], shiftStrength[i].right * strengthFactor, shiftStrength[i].falloff);
     }
 }
 
@@ -313,7 +326,7 @@ void ExecuteErupt(ecs_iter_t *it) {
         htw_geo_GridCoord start = positions[i];
         //htw_geo_GridCoord end = hexLineEndPoint(start, 20.0, angle);
         //shiftTerrainInLine(cm, start, end, elevation[i], 4, 1.0);
-        landslideParticle(cm, start);
+        landslideParticle(plane, start);
     }
 }
 
@@ -358,8 +371,13 @@ void BcSystemsElementalsImport(ecs_world_t *world) {
         [inout] SpiritPower,
         [inout] StormCloud,
         [in] Plane(up(bc.planes.IsIn)),
-        [in] Climate(up(bc.planes.IsIn))
+        [in] Climate(up(bc.planes.IsIn)),
+        [in] Step($)
     );
+    ecs_system(world, {
+        .entity = PrepStorm,
+        .multi_threaded = true
+    });
 
     ECS_SYSTEM(world, ExecuteShiftPlates, Execution,
         [in] Position,
@@ -0,0 +1,164 @@
+#include "bc_systems_commands.h"
+#include "basaltic_phases.h"
+#include "basaltic_components.h"
+#include "bc_components_commands.h"
+#include "basaltic_worldGen.h"
+#include "bc_brushStamp.h"
+#include "bc_flecs_utils.h"
+#include "htw_random.h"
+
+static void applyCellField(ecs_world_t *world, const bc_CellFieldCommand *command);
+static void applyRiver(ecs_world_t *world, const bc_RiverCommand *command);
+static void applySpawnPrefab(ecs_world_t *world, const bc_SpawnPrefabCommand *command);
+static void applySetDestination(ecs_world_t *world, const bc_SetDestinationCommand *command);
+static void applyLoadChunks(ecs_world_t *world, const bc_LoadChunksCommand *command);
+static void loadChunksAround(ecs_world_t *world, const Plane *plane, htw_geo_GridCoord center, u32 cellRadius);
+
+void ApplyModelCommands(ecs_iter_t *it) {
+    ModelCommandQueue *queue = ecs_field(it, ModelCommandQueue, 1);
+
+    bc_CommandBuffer commands = queue->commands;
+    if (bc_commandBufferIsEmpty(commands)) {
+        return;
+    }
+    bc_beginBufferProcessing(commands);
+    const bc_ModelCommandType *command;
+    while ((command = bc_getNextCommand(commands)) != NULL) {
+        switch (*command) {
+            case BC_COMMAND_CELL_FIELD_ADD:
+            case BC_COMMAND_CELL_FIELD_SET:
+                applyCellField(it->world, (const bc_CellFieldCommand*)command);
+                break;
+            case BC_COMMAND_RIVER_CONNECT:
+            case BC_COMMAND_RIVER_DISCONNECT:
+                applyRiver(it->world, (const bc_RiverCommand*)command);
+                break;
+            case BC_COMMAND_SPAWN_PREFAB:
+                applySpawnPrefab(it->world, (const bc_SpawnPrefabCommand*)command);
+                break;
+            case BC_COMMAND_SET_DESTINATION:
+                applySetDestination(it->world, (const bc_SetDestinationCommand*)command);
+                break;
+            case BC_COMMAND_LOAD_CHUNKS:
+                applyLoadChunks(it->world, (const bc_LoadChunksCommand*)command);
+                break;
+            default:
+                ecs_err("Unknown model command type: %d", *command);
+                break;
+        }
+    }
+    bc_endBufferProcessing(commands);
+}
+
+static void applyCellField(ecs_world_t *world, const bc_CellFieldCommand *command) {
+    const Plane *plane = ecs_get(world, command->plane, Plane);
+    if (plane == NULL) {
+        return;
+    }
+    htw_ChunkMap *cm = plane->chunkMap;
+    loadChunksAround(world, plane, command->center, command->radius);
+
+    const bc_BrushStamp *stamp = bc_getBrushStamp(command->radius);
+    for (int i = 0; i < stamp->area; i++) {
+        htw_geo_GridCoord cellCoord = htw_geo_addGridCoords(command->center, stamp->offsets[i]);
+        CellData *cd = htw_geo_getCell(cm, cellCoord);
+        void *fieldPtr = ((void*)cd) + command->fieldOffset;
+
+        s64 value = command->value;
+        if (command->type == BC_COMMAND_CELL_FIELD_ADD) {
+            value += bc_getMetaComponentMemberInt(fieldPtr, command->fieldKind);
+        }
+        bc_setMetaComponentMemberInt(fieldPtr, command->fieldKind, value);
+        if (command->fieldOffset == offsetof(CellData, height)) {
+            plane_UpdateCellBiotemperature(plane, cellCoord);
+        }
+    }
+}
+
+static void applyRiver(ecs_world_t *world, const bc_RiverCommand *command) {
+    const Plane *plane = ecs_get(world, command->plane, Plane);
+    if (plane == NULL) {
+        return;
+    }
+    htw_ChunkMap *cm = plane->chunkMap;
+
+    // need to account for world wrapping when computing distance
+    if (htw_geo_getChunkMapHexDistance(cm, command->a, command->b) != 1) {
+        return;
+    }
+    loadChunksAround(world, plane, command->a, 1);
+    if (command->type == BC_COMMAND_RIVER_CONNECT) {
+        bc_makeRiverConnection(cm, command->a, command->b, command->size);
+    } else {
+        bc_removeRiverConnection(cm, command->a, command->b);
+    }
+}
+
+static void applySpawnPrefab(ecs_world_t *world, const bc_SpawnPrefabCommand *command) {
+    if (!ecs_is_valid(world, command->plane) || !ecs_has(world, command->plane, Plane)) {
+        return;
+    }
+    loadChunksAround(world, ecs_get(world, command->plane, Plane), command->position, 0);
+    Step step = *ecs_singleton_get(world, Step);
+
+    ecs_entity_t e;
+    if (command->prefab != 0) {
+        if (!ecs_is_valid(world, command->prefab)) {
+            return;
+        }
+        e = bc_instantiateRandomizer(world, command->prefab);
+    } else {
+        e = ecs_new_w_pair(world, EcsChildOf, command->plane);
+    }
+    ecs_add_pair(world, e, IsIn, command->plane);
+    ecs_set(world, e, Position, {command->position.x, command->position.y});
+    ecs_set(world, e, CreationTime, {step});
+    // Taken from the command rather than the new entity's id, which depends on what was deleted before it
+    const DeterminismMode *determinism = ecs_singleton_get(world, DeterminismMode);
+    u32 words[] = {(u32)step, (u32)(step >> 32), (u32)command->position.x, (u32)command->position.y, (u32)command->prefab, (u32)(command->prefab >> 32)};
+    u32 seed = determinism == NULL ? 0 : determinism->seed;
+    ecs_set(world, e, ActorSeed, {((u64)xxh_hash(seed, sizeof(words), (u8*)words) << 32) | xxh_hash(~seed, sizeof(words), (u8*)words)});
+    plane_PlaceEntity(world, command->plane, e, command->position);
+}
+
+static void applySetDestination(ecs_world_t *world, const bc_SetDestinationCommand *command) {
+    // TODO: use plane to set destination on a different plane
+    if (ecs_is_valid(world, command->entity)) {
+        ecs_set(world, command->entity, Destination, {command->destination.x, command->destination.y});
+        ecs_add_pair(world, command->entity, Action, ActionMove);
+    }
+}
+
+static void applyLoadChunks(ecs_world_t *world, const bc_LoadChunksCommand *command) {
+    const Plane *plane = ecs_get(world, command->plane, Plane);
+    if (plane == NULL || plane->lazyChunks == NULL) {
+        return;
+    }
+    const JobPool *jobs = ecs_singleton_get(world, JobPool);
+    bc_makeChunksResident(plane, command->center, command->chunkRadius, jobs == NULL ? NULL : jobs->pool);
+}
+
+// Edits on a lazily generated plane must land in generated chunks, or generating them later would overwrite the edit
+static void loadChunksAround(ecs_world_t *world, const Plane *plane, htw_geo_GridCoord center, u32 cellRadius) {
+    if (plane->lazyChunks == NULL) {
+        return;
+    }
+    const JobPool *jobs = ecs_singleton_get(world, JobPool);
+    u32 chunkRadius = (cellRadius + plane->chunkMap->chunkSize - 1) / plane->chunkMap->chunkSize;
+    bc_makeChunksResident(plane, center, chunkRadius, jobs == NULL ? NULL : jobs->pool);
+}
+
+void BcSystemsCommandsImport(ecs_world_t *world) {
+    ECS_MODULE(world, BcSystemsCommands);
+
+    ECS_IMPORT(world, BcCommon);
+    ECS_IMPORT(world, BcPhases);
+    ECS_IMPORT(world, BcPlanes);
+    ECS_IMPORT(world, BcActors);
+    ECS_IMPORT(world, BcCommands);
+
+    // Not multi threaded: the model thread is the only consumer of the queue
+    ECS_SYSTEM(world, ApplyModelCommands, ApplyCommands,
+        [in] ModelCommandQueue($)
+    );
+}
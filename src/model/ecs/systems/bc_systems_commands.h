@@ -0,0 +1,8 @@
+#ifndef BC_SYSTEMS_COMMANDS_H_INCLUDED
+#define BC_SYSTEMS_COMMANDS_H_INCLUDED
+
+#include "flecs.h"
+
+void BcSystemsCommandsImport(ecs_world_t *world);
+
+#endif // BC_SYSTEMS_COMMANDS_H_INCLUDED
@@ -1,8 +1,11 @@
 #include "bc_systems_common.h"
 #include "bc_components_common.h"
 #include "basaltic_components_planes.h"
+#include "basaltic_components_actors.h"
 #include "basaltic_worldGen.h"
 #include "htw_random.h"
+#include <stdlib.h>
+#include <string.h>
 #include <sys/stat.h>
 
 typedef struct {
@@ -10,6 +13,8 @@ typedef struct {
     u32 width;
     u32 height;
     char *seed;
+    bool lazyChunks; // generate chunks the first time they're touched instead of all at once
+    bc_WorldGenOptions worldGen;
 } worldStartSettings;
 
 void argsToStartSettings(int argc, char *argv[], worldStartSettings *outSettings) {
@@ -17,10 +22,17 @@ void argsToStartSettings(int argc, char *argv[], worldStartSettings *outSettings
     outSettings->seed = "6174";
     outSettings->width = 3;
     outSettings->height = 3;
+    outSettings->lazyChunks = false;
+    outSettings->worldGen = (bc_WorldGenOptions){
+        .erosionDroplets = 0,
+        .erosionSeed = 0,
+        .smoothIterations = 0,
+        .smoothMinProminance = 24
+    };
     // TODO: make chunk size configurable with arg
     outSettings->chunkSize = 64;
 
-    // TODO: have this change settings according to name provided in arg; for now will use no names and expect a specific order
+    // First 3 args are positional, then any number of options in any order: `lazy`, or `name=value`
     for (int i = 0; i < argc; i++) {
         switch (i) {
             case 0:
@@ -33,6 +45,19 @@ void argsToStartSettings(int argc, char *argv[], worldStartSettings *outSettings
                 outSettings->height = htw_strToInt(argv[i]);
                 break;
             default:
+                if (strcmp(argv[i], "lazy") == 0) {
+                    outSettings->lazyChunks = true;
+                } else if (strncmp(argv[i], "erosion=", 8) == 0) {
+                    outSettings->worldGen.erosionDroplets = htw_strToInt(argv[i] + 8);
+                } else if (strncmp(argv[i], "erosionSeed=", 12) == 0) {
+                    outSettings->worldGen.erosionSeed = htw_strToInt(argv[i] + 12);
+                } else if (strncmp(argv[i], "smooth=", 7) == 0) {
+                    outSettings->worldGen.smoothIterations = htw_strToInt(argv[i] + 7);
+                } else if (strncmp(argv[i], "smoothThreshold=", 16) == 0) {
+                    outSettings->worldGen.smoothMinProminance = htw_strToInt(argv[i] + 16);
+                } else {
+                    ecs_warn("Unrecognized model start arg '%s'", argv[i]);
+                }
                 break;
         }
     }
@@ -40,6 +65,7 @@ void argsToStartSettings(int argc, char *argv[], worldStartSettings *outSettings
 
 void ParseArgs(ecs_iter_t *it) {
     Args *args = ecs_field(it, Args, 1);
+    bc_JobPool *pool = ecs_field_is_set(it, 2) ? ecs_field(it, JobPool, 2)->pool : NULL;
 
     worldStartSettings startSettings;
     argsToStartSettings(args->argc, args->argv, &startSettings);
@@ -47,11 +73,50 @@ void ParseArgs(ecs_iter_t *it) {
     // TODO: create additional singletons from start settings
 
     u32 seed = xxh_hash(0, 256, (u8*)startSettings.seed);
+    const DeterminismMode *determinism = ecs_singleton_get(it->world, DeterminismMode);
+    ecs_singleton_set(it->world, DeterminismMode, {.enabled = determinism != NULL && determinism->enabled, .seed = seed});
 
     // Create default terrain
+    WorldGenTimings timings = {0};
+    ecs_time_t start = {0};
+    ecs_time_measure(&start);
     htw_ChunkMap *cm = bc_createTerrain(startSettings.chunkSize, startSettings.width, startSettings.height);
-    bc_generateTerrain(cm, seed);
-    ecs_entity_t centralPlane = ecs_set(it->world, 0, Plane, {cm});
+    timings.allocateMs = ecs_time_measure(&start) * 1000.0;
+    bc_LazyChunks *lazyChunks = NULL;
+    if (startSettings.lazyChunks) {
+        // Chunks are generated around actors, edits, and the camera as they're touched
+        lazyChunks = bc_createLazyChunks(cm, seed);
+        if (startSettings.worldGen.erosionDroplets > 0 || startSettings.worldGen.smoothIterations > 0) {
+            ecs_warn("Erosion and smoothing work across chunks, so they're skipped on lazily generated planes");
+        }
+    } else {
+        const bc_WorldGenOptions *options = &startSettings.worldGen;
+        u64 cacheKey = bc_worldGenKey(startSettings.seed, seed, startSettings.chunkSize, startSettings.width, startSettings.height, options);
+        char cachePath[256];
+        bc_worldGenCachePath(cacheKey, cachePath, sizeof(cachePath));
+        ecs_time_measure(&start);
+        timings.fromCache = bc_loadTerrainCache(cm, cachePath, cacheKey);
+        if (!timings.fromCache) {
+            bc_generateTerrain(cm, seed, pool, &timings);
+            if (options->erosionDroplets > 0) {
+                ecs_time_measure(&start);
+                bc_erodeTerrain(cm, options->erosionDroplets, seed ^ options->erosionSeed, pool);
+                timings.erosionMs = ecs_time_measure(&start) * 1000.0;
+            }
+            if (options->smoothIterations > 0) {
+                ecs_time_measure(&start);
+                bc_smoothTerrain(cm, options->smoothMinProminance, options->smoothIterations, pool);
+                timings.smoothMs = ecs_time_measure(&start) * 1000.0;
+            }
+            ecs_time_measure(&start);
+            if (!bc_saveTerrainCache(cm, cachePath, cacheKey)) {
+                ecs_warn("Couldn't write worldgen cache %s", cachePath);
+            }
+        }
+        timings.cacheMs = ecs_time_measure(&start) * 1000.0;
+    }
+    ecs_singleton_set_ptr(it->world, WorldGenTimings, &timings);
+    ecs_entity_t centralPlane = ecs_set(it->world, 0, Plane, {.chunkMap = cm, .lazyChunks = lazyChunks});
     ecs_set_name(it->world, centralPlane, "Overworld");
 }
 
@@ -85,19 +150,113 @@ void ReloadPlecs(ecs_iter_t *it) {
     ecs_defer_resume(it->world);
 }
 
+// xxh_hash is 32 bit, so 64 bit hashes combine two differently seeded passes
+static u64 hashBytes64(u32 seed, size_t len, u8 *bytes) {
+    return ((u64)xxh_hash(seed, len, bytes) << 32) | xxh_hash(~seed, len, bytes);
+}
+
+typedef struct {
+    const htw_ChunkMap *chunkMap;
+    const bc_LazyChunks *lazyChunks;
+    u64 *chunkHashes;
+} ChunkHashJob;
+
+static void chunkHashJob(void *ctx, u32 chunkIndex) {
+    ChunkHashJob *job = ctx;
+    const htw_ChunkMap *cm = job->chunkMap;
+    // Contents of chunks that were never generated are undefined
+    if (job->lazyChunks != NULL && job->lazyChunks->states[chunkIndex] == LAZY_CHUNK_EMPTY) {
+        job->chunkHashes[chunkIndex] = 0;
+        return;
+    }
+    job->chunkHashes[chunkIndex] = hashBytes64(chunkIndex, cm->cellsPerChunk * sizeof(CellData), (u8*)cm->chunks[chunkIndex].cellData);
+}
+
+// First part of the world hash: every plane's CellData. Chunks are hashed in parallel, then combined in chunk order, so the result doesn't depend on thread count
+void HashPlanes(ecs_iter_t *it) {
+    WorldHash *hash = ecs_field(it, WorldHash, 1);
+    bc_JobPool *pool = ecs_field_is_set(it, 2) ? ecs_field(it, JobPool, 2)->pool : NULL;
+
+    u64 value = 0;
+    ecs_iter_t pit = ecs_term_iter(it->world, &(ecs_term_t){ .id = ecs_id(Plane) });
+    while (ecs_term_next(&pit)) {
+        Plane *planes = ecs_field(&pit, Plane, 1);
+        for (int i = 0; i < pit.count; i++) {
+            htw_ChunkMap *cm = planes[i].chunkMap;
+            u32 chunkCount = cm->chunkCountX * cm->chunkCountY;
+            ChunkHashJob job = {
+                .chunkMap = cm,
+                .lazyChunks = planes[i].lazyChunks,
+                .chunkHashes = malloc(chunkCount * sizeof(u64))
+            };
+            bc_parallelFor(pool, chunkCount, chunkHashJob, &job);
+            u64 planeHash = hashBytes64(chunkCount, chunkCount * sizeof(u64), (u8*)job.chunkHashes);
+            free(job.chunkHashes);
+            // FNV-1a style step, so plane order matters
+            value = (value ^ planeHash) * 0x100000001b3;
+        }
+    }
+    hash->step = *ecs_singleton_get(it->world, Step);
+    hash->value = value;
+}
+
+// Second part of the world hash: key components of every actor. Per-actor hashes are summed, so the result doesn't depend on table order or entity ids
+void HashActors(ecs_iter_t *it) {
+    Position *positions = ecs_field(it, Position, 1);
+    Destination *destinations = ecs_field_is_set(it, 2) ? ecs_field(it, Destination, 2) : NULL;
+    Condition *conditions = ecs_field_is_set(it, 3) ? ecs_field(it, Condition, 3) : NULL;
+    Group *groups = ecs_field_is_set(it, 4) ? ecs_field(it, Group, 4) : NULL;
+    GrowthRate *growthRates = ecs_field_is_set(it, 5) ? ecs_field(it, GrowthRate, 5) : NULL;
+    WorldHash *hash = ecs_field(it, WorldHash, 6);
+
+    for (int i = 0; i < it->count; i++) {
+        struct {
+            Position position;
+            Destination destination;
+            Condition condition;
+            Group group;
+            GrowthRate growthRate;
+        } actor;
+        // Zero padding and any missing components
+        memset(&actor, 0, sizeof(actor));
+        actor.position = positions[i];
+        if (destinations) actor.destination = destinations[i];
+        if (conditions) actor.condition = conditions[i];
+        if (groups) actor.group = groups[i];
+        if (growthRates) actor.growthRate = growthRates[i];
+        hash->value += hashBytes64(0, sizeof(actor), (u8*)&actor);
+    }
+}
+
 void IncrementStep(ecs_iter_t *it) {
     Step *step = ecs_field(it, Step, 1);
     (*step)++;
 }
 
+// Move every amortizable system to the tick source for the new mode
+void ApplyScheduleMode(ecs_iter_t *it) {
+    ScheduleMode mode = *ecs_field(it, ScheduleMode, 1);
+
+    ecs_iter_t sit = ecs_term_iter(it->world, &(ecs_term_t){ .id = ecs_id(AmortizedSystem) });
+    while (ecs_term_next(&sit)) {
+        AmortizedSystem *amortized = ecs_field(&sit, AmortizedSystem, 1);
+        for (int i = 0; i < sit.count; i++) {
+            ecs_set_tick_source(it->world, sit.entities[i], mode == SCHEDULE_MODE_AMORTIZED ? 0 : amortized[i].batchedTickSource);
+        }
+    }
+}
+
 void BcSystemsCommonImport(ecs_world_t *world) {
 
     ECS_MODULE(world, BcSystemsCommon);
 
     ECS_IMPORT(world, BcCommon);
+    ECS_IMPORT(world, BcPlanes);
+    ECS_IMPORT(world, BcActors);
 
     ECS_SYSTEM(world, ParseArgs, EcsOnStart,
-        [in] Args($)
+        [in] Args($),
+        [in] ?JobPool($)
     );
 
     // TODO does this do everything I need? Can I remove the equivalent from bc_flecs_utils?
@@ -112,9 +271,28 @@ void BcSystemsCommonImport(ecs_world_t *world) {
     ecs_entity_t reloadTick = ecs_set_interval(world, 0, 1.0);
     ecs_set_tick_source(world, ReloadPlecs, reloadTick);
 
+    // Must run after everything else in the step, but before IncrementStep
+    ECS_SYSTEM(world, HashPlanes, EcsOnStore,
+        [inout] WorldHash($),
+        [in] ?JobPool($)
+    );
+
+    ECS_SYSTEM(world, HashActors, EcsOnStore,
+        [in] Position,
+        [in] ?Destination,
+        [in] ?Condition,
+        [in] ?Group,
+        [in] ?GrowthRate,
+        [inout] WorldHash($)
+    );
+
     ECS_SYSTEM(world, IncrementStep, EcsOnStore,
         Step($)
     );
 
+    ECS_OBSERVER(world, ApplyScheduleMode, EcsOnSet,
+        [in] ScheduleMode($)
+    );
+
     ecs_singleton_set(world, Step, {0});
 }
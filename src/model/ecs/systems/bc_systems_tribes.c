@@ -12,7 +12,7 @@ void StockpileTickDay(ecs_iter_t *it) {
 
 void EgoBehaviorVillager(ecs_iter_t *it) {
     Condition *conditions = ecs_field(it, Condition, 1);
-    Stockpile *stockpiles = ecs_field(it, Stockpile, 2);
+    const Stockpile *stockpiles = ecs_field(it, Stockpile, 2);
     // constant source
     Step step = *ecs_field(it, Step, 3);
 
@@ -23,9 +23,10 @@ void EgoBehaviorVillager(ecs_iter_t *it) {
         "ActionSocalize", "ActionSocalize", "ActionSocalize", "ActionSocalize", "ActionSleep", "ActionSleep"
     };
 
+    // Same action for every villager this hour, only need to look it up once. Lookup only reads, safe on worker threads
+    s32 hour = step % 24;
+    ecs_entity_t action = ecs_lookup_child(it->world, Action, daySchedule[hour]);
     for (int i = 0; i < it->count; i++) {
-        s32 hour = step % 24;
-        ecs_entity_t action = ecs_lookup_child(it->world, Action, daySchedule[hour]);
         ecs_set_pair(it->world, it->entities[i], Action, action);
     }
 }
@@ -47,21 +48,37 @@ void BcSystemsTribesImport(ecs_world_t *world) {
 
     ECS_SYSTEM(world, EgoBehaviorVillager, Planning,
         [in] Condition,
-        [inout] Stockpile(up(bc.tribes.MemberOf)),
+        [in] Stockpile(up(bc.tribes.MemberOf)),
         [in] Step($),
         [none] bc.actors.Ego.EgoVillager
     );
+    ecs_system(world, {
+        .entity = EgoBehaviorVillager,
+        .multi_threaded = true
+    });
 
     // One reason his seems so hard to implement might be that a system is the wrong abstraction level for this action. Perhaps the actions should be SearchForTarget, Move, AttackTarget, Move, DepositGoods. The activity "Hunt" moves one level up to a behavior
     ECS_SYSTEM(world, ExecuteHunt, Execution,
         [none] (bc.actors.Action, bc.actors.Action.ActionHunt)
     );
+    ecs_system(world, {
+        .entity = ExecuteHunt,
+        .multi_threaded = true
+    });
 
     ECS_SYSTEM(world, ExecuteEatMeal, Execution,
         [none] (bc.actors.Action, bc.actors.Action.ActionEatMeal)
     );
+    ecs_system(world, {
+        .entity = ExecuteEatMeal,
+        .multi_threaded = true
+    });
 
     ECS_SYSTEM(world, ExecuteSocalize, Execution,
         [none] (bc.actors.Action, bc.actors.Action.ActionSocalize)
     );
+    ecs_system(world, {
+        .entity = ExecuteSocalize,
+        .multi_threaded = true
+    });
 }
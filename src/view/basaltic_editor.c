@@ -132,6 +132,8 @@ void modelSetupInspector(bc_SupervisorInterface *si);
 void modelWorldInspector(ecs_world_t *modelWorld, ecs_world_t *viewWorld);
 /** Returns true if the cell was altered */
 bool cellInspector(ecs_world_t *world, ecs_entity_t plane, htw_geo_GridCoord coord, ecs_entity_t *focusEntity);
+/** Map of chunk activity tiers, with the chunk containing focusCoord highlighted */
+void chunkActivityInspector(const Plane *plane, htw_geo_GridCoord focusCoord);
 void bitmaskToggle(const char *prefix, u32 *bitmask, u32 toggleBit);
 void dateTimeInspector(u64 step);
 void coordInspector(const char *label, htw_geo_GridCoord coord);
@@ -236,11 +238,20 @@ void bc_drawEditor(bc_SupervisorInterface *si, bc_ModelContext *model, ecs_world
         ModelStepControl *stepper = ecs_singleton_get_mut(viewWorld, ModelStepControl);
         igPushItemWidth(200);
 
-        // Tick rate slider TODO: change for new runforsteps method of scheduling model steps
-        //igSliderInt("Min Tick Duration", (int*)&model->tickInterval, 0, 1000, "%d", ImGuiSliderFlags_AlwaysClamp | ImGuiSliderFlags_Logarithmic);
         igSliderInt("Step batch size", (int*)&stepper->stepsPerRun, 1, 10000, "%d", ImGuiSliderFlags_AlwaysClamp | ImGuiSliderFlags_Logarithmic);
-        igSliderInt("Batch every n frames", (int*)&stepper->framesBetweenRuns, 1, 60, "%d", ImGuiSliderFlags_AlwaysClamp);
         igPopItemWidth();
+        // Auto step rate and lag clamp are set in Engine Options
+        if (model->tickRate == 0) {
+            igText("Auto step rate: unlimited");
+        } else {
+            igText("Auto step rate: %u steps/s", model->tickRate);
+        }
+        igValue_Uint("Steps dropped by lag limit", model->droppedSteps);
+        const ModelWorld *mw = ecs_singleton_get(viewWorld, ModelWorld);
+        if (mw != NULL && mw->backlog != NULL) {
+            igValue_Uint("Model commands waiting for space", mw->backlog->count);
+            igValue_Uint("Model commands dropped", mw->backlog->dropped);
+        }
 
         if (igButton("Advance logic step by batch size", (ImVec2){0, 0})) {
             stepper->doSingleRun = true;
@@ -260,7 +271,7 @@ void bc_drawEditor(bc_SupervisorInterface *si, bc_ModelContext *model, ecs_world
         igSpacing();
 
         /* Don't inspect model while it's running */
-        if (SDL_TryLockMutex(model->mutex) == 0) {
+        if (model_tryLock(model)) {
             ecs_world_t *modelWorld = model->world;
             // set model ecs world scope, to keep view's external tags/queries separate
             ecs_entity_t oldScope = ecs_get_scope(modelWorld);
@@ -286,7 +297,7 @@ void bc_drawGUI(bc_SupervisorInterface *si, bc_ModelContext *model, ecs_world_t
         igEnd();
     } else {
         ecs_world_t *modelWorld = NULL;
-        if (SDL_TryLockMutex(model->mutex) == 0) {
+        if (model_tryLock(model)) {
             modelWorld = model->world;
             // NOTE: not good practice to have the unlock outside lock scope; will improve when eventually reorganizing GUI
         }
@@ -420,15 +431,22 @@ void bc_drawGUI(bc_SupervisorInterface *si, bc_ModelContext *model, ecs_world_t
                         static s32 smoothIterations = 30;
                         igText("Smoothing");
                         igSliderInt("##smoothThreshold", &smoothThreshold, 0, 100, "Threshold: %i", 0);
-                        igSliderInt("##smoothIterations", &smoothThreshold, 1, 50, "Iterations: %i", 0);
+                        igSliderInt("##smoothIterations", &smoothIterations, 1, 50, "Iterations: %i", 0);
+                        const FocusPlane *fp = ecs_singleton_get(viewWorld, FocusPlane);
+                        // Smoothing works across chunks, and every empty chunk of a lazy plane shares the same cells
+                        bool canSmooth = ecs_get(modelWorld, fp->entity, Plane)->lazyChunks == NULL;
+                        igBeginDisabled(!canSmooth);
                         if (igButton("Smooth map", IG_SIZE_DEFAULT)) {
-                            const FocusPlane *fp = ecs_singleton_get(viewWorld, FocusPlane);
-                            const Plane *plane = ecs_get(modelWorld, fp->entity, Plane);
-                            for (int i = 0; i < smoothIterations; i++) {
-                                bc_smoothTerrain(plane->chunkMap, smoothThreshold);
-                            }
+                            Plane *plane = ecs_get_mut(modelWorld, fp->entity, Plane);
+                            bc_smoothTerrain(plane->chunkMap, smoothThreshold, smoothIterations, NULL);
+                            plane_InvalidateBiotemperature(plane);
                             bc_redraw_model(viewWorld);
                         }
+                        igEndDisabled();
+                        if (!canSmooth) {
+                            igSameLine(0, -1);
+                            igText("Not available on lazily generated planes");
+                        }
 
                         // TEST: Just copy the same values to the value brush instead of having separate settings
                         ecs_singleton_set(viewWorld, ValueBrush, {ab->value});
@@ -666,6 +684,8 @@ void modelWorldInspector(ecs_world_t *modelWorld, ecs_world_t *viewWorld) {
             // Tell view to update chunk map
             bc_redraw_model(viewWorld);
         }
+
+        chunkActivityInspector(ecs_get(modelWorld, focusedPlane, Plane), focusCoord);
     }
 
     // Misc options
@@ -683,7 +703,12 @@ bool cellInspector(ecs_world_t *world, ecs_entity_t plane, htw_geo_GridCoord coo
 
     coordInspector("Cell coordinates", coord);
 
-    if (igCollapsingHeader_TreeNodeFlags("Cell Data", 0)) {
+    u32 chunkIndex, cellIndex;
+    htw_geo_gridCoordinateToChunkAndCellIndex(cm, coord, &chunkIndex, &cellIndex);
+    if (!plane_IsChunkGenerated(p, chunkIndex)) {
+        // Empty chunks share their cells, so editing one would edit them all
+        igText("Chunk not generated yet");
+    } else if (igCollapsingHeader_TreeNodeFlags("Cell Data", 0)) {
         igSpacing();
 
         // TODO: should make some of this layout automatic based on CellData component reflection info, in case I change the types around
@@ -752,6 +777,46 @@ bool cellInspector(ecs_world_t *world, ecs_entity_t plane, htw_geo_GridCoord coo
     return edited;
 }
 
+void chunkActivityInspector(const Plane *plane, htw_geo_GridCoord focusCoord) {
+    if (!igCollapsingHeader_TreeNodeFlags("Chunk Activity", 0)) {
+        return;
+    }
+    const bc_ChunkActivity *activity = plane->activity;
+    if (activity == NULL) {
+        igText("Not classified yet; every chunk updates daily");
+        return;
+    }
+    htw_ChunkMap *cm = plane->chunkMap;
+
+    // Same order as ChunkActivityTier
+    static const char *tierNames[] = {"Active", "Distant", "Submerged"};
+    static const char tierSymbols[] = {'#', '.', '~'};
+    u32 tierCounts[3] = {0};
+    for (u32 c = 0; c < activity->chunkCount; c++) {
+        tierCounts[activity->tiers[c]]++;
+    }
+    for (int t = 0; t < 3; t++) {
+        igText("%c %s: %u chunks (%.1f%%)", tierSymbols[t], tierNames[t], tierCounts[t], 100.0 * (float)tierCounts[t] / (float)activity->chunkCount);
+    }
+
+    u32 focusChunk, focusCell;
+    htw_geo_gridCoordinateToChunkAndCellIndex(cm, focusCoord, &focusChunk, &focusCell);
+    igText("Focused chunk: %s, last updated at step %llu", tierNames[activity->tiers[focusChunk]], (unsigned long long)activity->lastUpdateSteps[focusChunk]);
+
+    // One character per chunk, focused chunk shown as '@'
+    char *row = malloc(cm->chunkCountX + 1);
+    for (u32 y = 0; y < cm->chunkCountY; y++) {
+        for (u32 x = 0; x < cm->chunkCountX; x++) {
+            u32 chunkIndex, cellIndex;
+            htw_geo_gridCoordinateToChunkAndCellIndex(cm, (htw_geo_GridCoord){x * cm->chunkSize, y * cm->chunkSize}, &chunkIndex, &cellIndex);
+            row[x] = chunkIndex == focusChunk ? '@' : tierSymbols[activity->tiers[chunkIndex]];
+        }
+        row[cm->chunkCountX] = '\0';
+        igTextUnformatted(row, NULL);
+    }
+    free(row);
+}
+
 void ecsWorldInspector(ecs_world_t *world, EcsInspectionContext *ic) {
     igPushID_Ptr(world);
 
@@ -79,8 +79,9 @@ u32 bc_view_drawFrame(bc_SupervisorInterface *si, bc_WindowContext *wc) {
     if (world != NULL) {
         ModelWorld *mw = ecs_singleton_get_mut(vc.ecsWorld, ModelWorld);
         bool stepChanged = mw->lastRenderedStep < model->step;
+        bool refreshSnapshot = mw->renderOutdated;
         if (stepChanged || mw->renderOutdated) {
-            if (SDL_TryLockMutex(model->mutex) == 0) {
+            if (model_tryLock(model)) {
                 // set model ecs world scope, to keep view's external tags/queries separate
                 ecs_entity_t viewScope = ecs_entity_init(world, &(ecs_entity_desc_t){.name = "bcview"});
                 ecs_entity_t oldScope = ecs_set_scope(world, viewScope);
@@ -89,22 +90,37 @@ u32 bc_view_drawFrame(bc_SupervisorInterface *si, bc_WindowContext *wc) {
                 ecs_run_pipeline(vc.ecsWorld, ModelChangedPipeline, 1.0f);
                 ecs_set_scope(world, oldScope);
                 SDL_UnlockMutex(model->mutex);
+                // Anything that depends on query results may need to be refreshed too
+                refreshSnapshot = true;
             }
         }
+        // Doesn't need the model lock, so rendering can keep up with the model even while it is running a long batch
+        bool isNewSnapshot;
+        const bc_ModelSnapshot *snapshot = bc_acquireModelSnapshot(model->snapshots, &isNewSnapshot);
+        if (isNewSnapshot || refreshSnapshot) {
+            ecs_singleton_set(vc.ecsWorld, ModelSnapshot, {snapshot});
+            ecs_run_pipeline(vc.ecsWorld, SnapshotChangedPipeline, 1.0f);
+        }
         mw->lastRenderedStep = model->step;
-        mw->renderOutdated = false;
+        // A new snapshot without a new step means commands were applied while paused. Entities may have been added, so refresh model queries next frame
+        mw->renderOutdated = isNewSnapshot && !stepChanged && snapshot->step == model->step;
         ecs_singleton_modified(vc.ecsWorld, ModelWorld);
 
-        // Queue up model steps to run
+        // Queue up model steps to run. While auto stepping, the model thread schedules its own steps at the engine tick rate
         ModelStepControl *stepper = ecs_singleton_get_mut(vc.ecsWorld, ModelStepControl);
-        model->runForSteps = stepper->stepsPerRun;
-        if (stepper->doSingleRun) {
-            stepper->doSingleRun = false;
-            ecs_singleton_modified(vc.ecsWorld, ModelStepControl);
-            SDL_CondSignal(model->cond);
-        } else if (stepper->doAuto) {
-            if (wc->frame % stepper->framesBetweenRuns == 0) {
+        // While auto stepping, commands are applied at the start of the next step
+        bool wakeForCommands = !model->autoStep && !bc_commandBufferIsEmpty(model->commands);
+        if (stepper->doSingleRun || stepper->doAuto != model->autoStep || wakeForCommands) {
+            // Change and signal while holding the lock, so the model can't miss the signal between checking for work and waiting. If the model is busy, the change stays pending and is retried next frame
+            if (model_tryLock(model)) {
+                if (stepper->doSingleRun) {
+                    stepper->doSingleRun = false;
+                    ecs_singleton_modified(vc.ecsWorld, ModelStepControl);
+                    model->runForSteps = stepper->stepsPerRun;
+                }
+                model->autoStep = stepper->doAuto;
                 SDL_CondSignal(model->cond);
+                SDL_UnlockMutex(model->mutex);
             }
         }
     }
@@ -115,7 +131,7 @@ u32 bc_view_drawFrame(bc_SupervisorInterface *si, bc_WindowContext *wc) {
 
 void bc_view_onModelStart(bc_ModelContext *mctx) {
     model = mctx;
-    ecs_singleton_set(vc.ecsWorld, ModelWorld, {.world = model->world, .lastRenderedStep = 0, .renderOutdated = true});
+    ecs_singleton_set(vc.ecsWorld, ModelWorld, {.world = model->world, .lastRenderedStep = 0, .renderOutdated = true, .commands = model->commands, .backlog = calloc(1, sizeof(bc_ModelCommandBacklog))});
     // Find first Plane entity in model to use a default focus
     ecs_entity_t modelPlaneId = ecs_lookup_fullpath(model->world, "bc.planes.Plane");
     ecs_iter_t planes = ecs_term_iter(model->world, &(ecs_term_t){
@@ -135,7 +151,13 @@ void bc_view_onModelStart(bc_ModelContext *mctx) {
 }
 
 void bc_view_onModelStop(bc_ModelContext *mctx) {
+    // Anything still waiting was meant for the model being stopped
+    const ModelWorld *mw = ecs_singleton_get(vc.ecsWorld, ModelWorld);
+    if (mw != NULL) {
+        free(mw->backlog);
+    }
     ecs_singleton_remove(vc.ecsWorld, ModelWorld);
+    ecs_singleton_remove(vc.ecsWorld, ModelSnapshot);
     bc_editorOnModelStop();
     model = NULL;
 }
@@ -90,6 +90,8 @@ void BcviewImport(ecs_world_t *world) {
     ECS_META_COMPONENT(world, ModelWorld);
     ECS_META_COMPONENT(world, ModelStepControl);
     ECS_META_COMPONENT(world, ModelQuery);
+    ECS_META_COMPONENT(world, ModelSnapshot);
+    ECS_META_COMPONENT(world, ModelQueryCache);
     ECS_META_COMPONENT(world, QueryDesc);
     //ECS_COMPONENT_DEFINE(world, ModelLastRenderedStep);
 
@@ -217,7 +219,6 @@ void BcviewImport(ecs_world_t *world) {
 
     ecs_singleton_set(world, ModelStepControl, {
         .stepsPerRun = 1,
-        .framesBetweenRuns = 1
     });
 
     ecs_singleton_add(world, GlobalUniformsVert);
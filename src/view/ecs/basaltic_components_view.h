@@ -3,6 +3,7 @@
 
 #include "htw_core.h"
 #include "basaltic_components.h"
+#include "bc_modelSnapshot.h"
 #include <time.h>
 #include "ccVector.h"
 #include "sokol_gfx.h"
@@ -43,10 +44,25 @@ BC_DECL ECS_COMPONENT_DECLARE(Rect);
 
 /* Connection to Model */
 
+#define BC_MODEL_COMMAND_BACKLOG_LENGTH 256
+
+// Commands that didn't fit in the model's command ring yet, oldest first. Retried every frame before any new command is pushed, so commands always reach the model in order
+typedef struct {
+    u32 first;
+    u32 count;
+    u64 dropped; // commands lost because the backlog was full as well
+    size_t sizes[BC_MODEL_COMMAND_BACKLOG_LENGTH];
+    bc_ModelCommand commands[BC_MODEL_COMMAND_BACKLOG_LENGTH];
+} bc_ModelCommandBacklog;
+
 ECS_STRUCT(ModelWorld, {
     ecs_world_t *world;
     u64 lastRenderedStep;
     bool renderOutdated;
+    ECS_PRIVATE;
+    // Edits to the model must be pushed here instead of changing the model world directly, see bc_components_commands.h. Use bc_sendModelCommand, which keeps commands in backlog while the ring is full
+    bc_CommandBuffer commands;
+    bc_ModelCommandBacklog *backlog;
 });
 
 #define bc_redraw_model(view_world) { \
@@ -56,7 +72,6 @@ ECS_STRUCT(ModelWorld, {
 
 ECS_STRUCT(ModelStepControl, {
     s32 stepsPerRun;
-    s32 framesBetweenRuns;
     bool doSingleRun;
     bool doAuto;
 });
@@ -65,6 +80,19 @@ ECS_STRUCT(ModelQuery, {
     ecs_query_t *query;
 });
 
+// Latest snapshot published by the model. Can be read at any time without locking the model; valid until the next time SnapshotChangedPipeline runs
+ECS_STRUCT(ModelSnapshot, {
+    const bc_ModelSnapshot *snapshot;
+});
+
+// Model entities matched by a ModelQuery the last time the model could be locked. Lets renderers update positions from ModelSnapshot while the model is busy
+ECS_STRUCT(ModelQueryCache, {
+    s32 count;
+    s32 capacity;
+    ECS_PRIVATE;
+    ecs_entity_t *entities;
+});
+
 ECS_STRUCT(QueryDesc, {
     char *expr;
 });
@@ -19,8 +19,10 @@ ECS_TAG_DECLARE(EndPassTransparent);
 ECS_TAG_DECLARE(OnPassFinal);
 
 ECS_TAG_DECLARE(OnModelChanged);
+ECS_TAG_DECLARE(OnSnapshotChanged);
 
 ECS_DECLARE(ModelChangedPipeline);
+ECS_DECLARE(SnapshotChangedPipeline);
 
 // returns a dummy phase with the same depth as endPhase; should use this as the dependsOn arg of further calls or phases
 ecs_entity_t createPassPhases(ecs_world_t *world, ecs_entity_t dependsOn, ecs_entity_t beginPhase, ecs_entity_t onPhase, ecs_entity_t endPhase);
@@ -73,6 +75,7 @@ void BcviewPhasesImport(ecs_world_t *world) {
     ECS_TAG_DEFINE(world, OnPassFinal);
 
     ECS_TAG_DEFINE(world, OnModelChanged);
+    ECS_TAG_DEFINE(world, OnSnapshotChanged);
 
     ecs_entity_t dummyPhase = createPassPhases(world, EcsOnUpdate, BeginPassShadow, OnPassShadow, EndPassShadow);
     dummyPhase = createPassPhases(world, dummyPhase, BeginPassGBuffer, OnPassGBuffer, EndPassGBuffer);
@@ -89,4 +92,12 @@ void BcviewPhasesImport(ecs_world_t *world) {
             { .id = OnModelChanged } // EcsOr in all the phase tags you want this pipeline to run
         }
     });
+
+    // Runs when a new model snapshot is available. Systems in this phase must only read from ModelSnapshot, never from the model world
+    SnapshotChangedPipeline = ecs_pipeline(world, {
+        .query.filter.terms = {
+            { .id = EcsSystem },
+            { .id = OnSnapshotChanged }
+        }
+    });
 }
@@ -22,8 +22,10 @@ extern ECS_TAG_DECLARE(EndPassTransparent);
 extern ECS_TAG_DECLARE(OnPassFinal);
 
 extern ECS_TAG_DECLARE(OnModelChanged);
+extern ECS_TAG_DECLARE(OnSnapshotChanged);
 
 extern ECS_DECLARE(ModelChangedPipeline);
+extern ECS_DECLARE(SnapshotChangedPipeline);
 
 void BcviewPhasesImport(ecs_world_t *world);
 
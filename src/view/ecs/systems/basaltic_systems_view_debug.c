@@ -164,14 +164,60 @@ static sg_pipeline_desc debugRTPipelineDescription = {
     .label = "debug-RT-pipeline",
 };
 
-void UpdateDebugBuffers(ecs_iter_t *it) {
+void InitModelQueryCaches(ecs_iter_t *it) {
+    InstanceBuffer *instanceBuffers = ecs_field(it, InstanceBuffer, 1);
+
+    for (int i = 0; i < it->count; i++) {
+        // Can't draw more than maxInstances, so no need to remember more entities than that
+        s32 capacity = instanceBuffers[i].maxInstances;
+        ecs_set(it->world, it->entities[i], ModelQueryCache, {.count = 0, .capacity = capacity, .entities = calloc(capacity, sizeof(ecs_entity_t))});
+    }
+}
+
+// Entities in a cache belong to the model world, so caches are dropped when the model is detached and recreated for the next one
+void RemoveModelQueryCaches(ecs_iter_t *it) {
+    for (int i = 0; i < it->count; i++) {
+        ecs_remove(it->world, it->entities[i], ModelQueryCache);
+    }
+}
+
+// Also runs for every cache when the view world is destroyed
+void FreeModelQueryCaches(ecs_iter_t *it) {
+    ModelQueryCache *caches = ecs_field(it, ModelQueryCache, 1);
+    for (int i = 0; i < it->count; i++) {
+        free(caches[i].entities);
+        caches[i].entities = NULL;
+        caches[i].count = 0;
+        caches[i].capacity = 0;
+    }
+}
+
+// Only remembers which entities match, positions are read from the model snapshot by UpdateDebugBuffers
+void UpdateModelQueryCaches(ecs_iter_t *it) {
     ModelQuery *queries = ecs_field(it, ModelQuery, 1);
+    ModelQueryCache *caches = ecs_field(it, ModelQueryCache, 2);
+    ecs_world_t *modelWorld = ecs_field(it, ModelWorld, 3)->world;
+
+    for (int i = 0; i < it->count; i++) {
+        ModelQueryCache *cache = &caches[i];
+        cache->count = 0;
+        ecs_iter_t mit = ecs_query_iter(modelWorld, queries[i].query);
+        while (ecs_query_next(&mit)) {
+            for (int m = 0; m < mit.count && cache->count < cache->capacity; m++) {
+                cache->entities[cache->count++] = mit.entities[m];
+            }
+        }
+    }
+}
+
+void UpdateDebugBuffers(ecs_iter_t *it) {
+    ModelQueryCache *caches = ecs_field(it, ModelQueryCache, 1);
     InstanceBuffer *instanceBuffers = ecs_field(it, InstanceBuffer, 2);
     // Optional term, may be null
     Color *colors = ecs_field(it, Color, 3);
     // constant source
     const vec3 *scale = ecs_field(it, Scale, 4);
-    ecs_world_t *modelWorld = ecs_field(it, ModelWorld, 5)->world;
+    const bc_ModelSnapshot *snapshot = ecs_field(it, ModelSnapshot, 5)->snapshot;
 
     for (int i = 0; i < it->count; i++) {
         DebugInstanceData *instanceData = instanceBuffers[i].data;
@@ -180,23 +226,32 @@ void UpdateDebugBuffers(ecs_iter_t *it) {
         }
         u32 instanceCount = 0;
 
-        ecs_iter_t mit = ecs_query_iter(modelWorld, queries[i].query);
-        while (ecs_query_next(&mit)) {
-            Position *positions = ecs_field(&mit, Position, 1);
-            htw_ChunkMap *cm = ecs_field(&mit, Plane, 2)->chunkMap;
-            for (int m = 0; m < mit.count && instanceCount < instanceBuffers[i].maxInstances; m++) {
-                u32 chunkIndex, cellIndex;
-                htw_geo_gridCoordinateToChunkAndCellIndex(cm, positions[m], &chunkIndex, &cellIndex);
-                s32 elevation = bc_getCellByIndex(cm, chunkIndex, cellIndex)->height;
-                float posX, posY;
-                htw_geo_getHexCellPositionSkewed(positions[m], &posX, &posY);
-                instanceData[instanceCount] = (DebugInstanceData){
-                    .position = {.xyz = vec3MultiplyVector((vec3){{posX, posY, elevation}}, *scale), .__w = 1.0},
-                    .color = colors == NULL ? (vec4){{1.0, 0.0, 1.0, 1.0}} : colors[i],
-                    .scale = 1.0
-                };
-                instanceCount++;
+        // Entities are usually grouped by plane, avoid looking up the same plane every time
+        const bc_SnapshotPlane *sp = NULL;
+        for (int m = 0; m < caches[i].count && instanceCount < instanceBuffers[i].maxInstances; m++) {
+            const bc_SnapshotEntity *se = bc_findSnapshotEntity(snapshot, caches[i].entities[m]);
+            // may have been deleted since the query was cached
+            if (se == NULL) {
+                continue;
             }
+            if (sp == NULL || sp->entity != se->plane) {
+                sp = bc_findSnapshotPlane(snapshot, se->plane);
+                if (sp == NULL) {
+                    continue;
+                }
+            }
+            htw_ChunkMap *cm = sp->plane.chunkMap;
+            u32 chunkIndex, cellIndex;
+            htw_geo_gridCoordinateToChunkAndCellIndex(cm, se->position, &chunkIndex, &cellIndex);
+            s32 elevation = bc_getCellByIndex(cm, chunkIndex, cellIndex)->height;
+            float posX, posY;
+            htw_geo_getHexCellPositionSkewed(se->position, &posX, &posY);
+            instanceData[instanceCount] = (DebugInstanceData){
+                .position = {.xyz = vec3MultiplyVector((vec3){{posX, posY, elevation}}, *scale), .__w = 1.0},
+                .color = colors == NULL ? (vec4){{1.0, 0.0, 1.0, 1.0}} : colors[i],
+                .scale = 1.0
+            };
+            instanceCount++;
         }
         instanceBuffers[i].instances = instanceCount;
         sg_update_buffer(instanceBuffers[i].buffer, &(sg_range){.ptr = instanceData, .size = instanceBuffers[i].size});
@@ -254,9 +309,15 @@ void UpdateRiverArrowBuffers(ecs_iter_t *it) {
     Color *colors = ecs_field(it, Color, 2);
     // constant source
     const vec3 *scale = ecs_field(it, Scale, 3);
-    ecs_world_t *modelWorld = ecs_field(it, ModelWorld, 4)->world;
+    const bc_ModelSnapshot *snapshot = ecs_field(it, ModelSnapshot, 4)->snapshot;
     const FocusPlane *fp = ecs_field(it, FocusPlane, 5);
 
+    const bc_SnapshotPlane *sp = bc_findSnapshotPlane(snapshot, fp->entity);
+    if (sp == NULL) {
+        return;
+    }
+    htw_ChunkMap *cm = sp->plane.chunkMap;
+
     for (int i = 0; i < it->count; i++) {
         ArrowInstanceData *instanceData = instanceBuffers[i].data;
         if (instanceData == NULL) {
@@ -264,9 +325,6 @@ void UpdateRiverArrowBuffers(ecs_iter_t *it) {
         }
         u32 instanceCount = 0;
 
-        const Plane *plane = ecs_get(modelWorld, fp->entity, Plane);
-        htw_ChunkMap *cm = plane->chunkMap;
-
         const float lineWidth = 0.03;
 
         for (int y = 0; y < cm->mapHeight; y++) {
@@ -394,12 +452,35 @@ void BcviewSystemsDebugImport(ecs_world_t *world) {
     ECS_IMPORT(world, Bcview);
     ECS_IMPORT(world, BcviewPhases);
 
-    ECS_SYSTEM(world, UpdateDebugBuffers, OnModelChanged,
+    ECS_SYSTEM(world, InitModelQueryCaches, EcsOnLoad,
+        [in] (InstanceBuffer, DebugInstanceData),
+        [out] !ModelQueryCache,
+        [none] ModelWorld($),
+        [none] bcview.DebugRender
+    );
+
+    ECS_SYSTEM(world, RemoveModelQueryCaches, EcsOnLoad,
+        [out] ModelQueryCache,
+        [none] !ModelWorld($)
+    );
+
+    ECS_OBSERVER(world, FreeModelQueryCaches, EcsOnRemove,
+        ModelQueryCache
+    );
+
+    ECS_SYSTEM(world, UpdateModelQueryCaches, OnModelChanged,
         [in] ModelQuery,
+        [inout] ModelQueryCache,
+        [in] ModelWorld($),
+        [none] bcview.DebugRender
+    );
+
+    ECS_SYSTEM(world, UpdateDebugBuffers, OnSnapshotChanged,
+        [in] ModelQueryCache,
         [inout] (InstanceBuffer, DebugInstanceData),
         [in] ?Color,
         [in] Scale($),
-        [in] ModelWorld($),
+        [in] ModelSnapshot($),
         [none] bcview.DebugRender
     );
 
@@ -412,11 +493,11 @@ void BcviewSystemsDebugImport(ecs_world_t *world) {
         [none] bcview.DebugRender
     );
 
-    ECS_SYSTEM(world, UpdateRiverArrowBuffers, OnModelChanged,
+    ECS_SYSTEM(world, UpdateRiverArrowBuffers, OnSnapshotChanged,
         [inout] (InstanceBuffer, ArrowInstanceData),
         [in] ?Color,
         [in] Scale($),
-        [in] ModelWorld($),
+        [in] ModelSnapshot($),
         [in] FocusPlane($),
         [none] bcview.DebugRender,
         [none] bcview.TerrainRender
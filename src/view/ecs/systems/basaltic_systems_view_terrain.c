@@ -124,7 +124,7 @@ Mesh createTriGridMesh(u32 width, u32 height, u32 subdivisions);
 Mesh createHexmapMesh(u32 width, u32 height);
 void updateTerrainVisibleChunks(Plane *plane, TerrainBuffer *terrain, DataTexture *dataTexture, u32 centerChunk);
 
-void updateDataTextureChunk(Plane *plane, Climate *climate, DataTexture *dataTexture, u32 chunkIndex);
+void updateDataTextureChunk(const Plane *plane, const Climate *climate, DataTexture *dataTexture, u32 chunkIndex);
 
 void UpdateTerrainInstances(ecs_iter_t *it);
 
@@ -767,7 +767,11 @@ void updateTerrainVisibleChunks(Plane *plane, TerrainBuffer *terrain, DataTextur
     }
 }
 
-void updateDataTextureChunk(Plane *plane, Climate *climate, DataTexture *dataTexture, u32 chunkIndex) {
+void updateDataTextureChunk(const Plane *plane, const Climate *climate, DataTexture *dataTexture, u32 chunkIndex) {
+    // Nothing to show until lazy generation reaches the chunk; its texels keep their cleared values
+    if (!plane_IsChunkGenerated(plane, chunkIndex)) {
+        return;
+    }
     htw_ChunkMap *chunkMap = plane->chunkMap;
     u32 width = chunkMap->chunkSize;
     u32 height = chunkMap->chunkSize;
@@ -916,40 +920,25 @@ void DestroyDataTextures(ecs_iter_t *it) {
 }
 
 // TODO need to refine the structure here; either each terrain renderer should correspond to exactly one Plane, or they need a way to generalize to several Planes (=several data textures)
+// Reads terrain from the latest model snapshot instead of the model, so this can run while the model is busy. Snapshot contains every entity matching the terrain renderer's "Plane, ?Climate" query
 void UpdateTerrainDataTexture(ecs_iter_t *it) {
-    ModelQuery *queries = ecs_field(it, ModelQuery, 1);
-    DataTexture *dataTextures = ecs_field(it, DataTexture, 2);
-
-    ecs_world_t *modelWorld = ecs_singleton_get(it->world, ModelWorld)->world;
+    DataTexture *dataTextures = ecs_field(it, DataTexture, 1);
+    const bc_ModelSnapshot *snapshot = ecs_field(it, ModelSnapshot, 2)->snapshot;
 
     for (int i = 0; i < it->count; i++) {
-        ecs_iter_t mit = ecs_query_iter(modelWorld, queries[i].query);
-        while (ecs_query_next(&mit)) {
-            Plane *planes = ecs_field(&mit, Plane, 1);
-            // optional climate
-            if (ecs_field_is_set(&mit, 2)) {
-                Climate *climates = ecs_field(&mit, Climate, 2);
-
-                for (int m = 0; m < mit.count; m++) {
-                    htw_ChunkMap *cm = planes[m].chunkMap;
-                    DataTexture dt = dataTextures[i];
-                    for (int c = 0; c < (cm->chunkCountX * cm->chunkCountY); c++) {
-                        updateDataTextureChunk(&planes[m], &climates[m], &dt, c);
-                    }
-
-                    sg_update_image(dt.image, &(sg_image_data){.subimage[0][0] = {dt.data, dt.size}});
-                }
-            } else {
-                for (int m = 0; m < mit.count; m++) {
-                    htw_ChunkMap *cm = planes[m].chunkMap;
-                    DataTexture dt = dataTextures[i];
-                    for (int c = 0; c < (cm->chunkCountX * cm->chunkCountY); c++) {
-                        updateDataTextureChunk(&planes[m], NULL, &dt, c);
-                    }
-
-                    sg_update_image(dt.image, &(sg_image_data){.subimage[0][0] = {dt.data, dt.size}});
-                }
+        for (int p = 0; p < snapshot->planeCount; p++) {
+            const bc_SnapshotPlane *sp = &snapshot->planes[p];
+            htw_ChunkMap *cm = sp->plane.chunkMap;
+            DataTexture dt = dataTextures[i];
+            // Texture may have been created for a different model
+            if (dt.width != cm->mapWidth || dt.height != cm->mapHeight) {
+                continue;
+            }
+            for (int c = 0; c < (cm->chunkCountX * cm->chunkCountY); c++) {
+                updateDataTextureChunk(&sp->plane, sp->hasClimate ? &sp->climate : NULL, &dt, c);
             }
+
+            sg_update_image(dt.image, &(sg_image_data){.subimage[0][0] = {dt.data, dt.size}});
         }
     }
 }
@@ -1145,10 +1134,9 @@ void BcviewSystemsTerrainImport(ecs_world_t *world) {
     );
 
     // Only need to run when model step advances
-    ECS_SYSTEM(world, UpdateTerrainDataTexture, OnModelChanged,
-               [in] ModelQuery,
+    ECS_SYSTEM(world, UpdateTerrainDataTexture, OnSnapshotChanged,
                [inout] DataTexture,
-               [in] ModelWorld($),
+               [in] ModelSnapshot($),
                [none] bcview.TerrainRender,
     );
 
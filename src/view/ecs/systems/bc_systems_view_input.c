@@ -5,8 +5,50 @@
 #include "bc_flecs_utils.h"
 #include "basaltic_worldGen.h"
 #include <math.h>
+#include <string.h>
 #include <SDL2/SDL.h>
 
+static bool flushBacklog(ModelWorld *mw) {
+    bc_ModelCommandBacklog *backlog = mw->backlog;
+    while (backlog->count > 0) {
+        u32 i = backlog->first;
+        if (!bc_pushCommandToBuffer(mw->commands, &backlog->commands[i], backlog->sizes[i])) {
+            return false;
+        }
+        backlog->first = (i + 1) % BC_MODEL_COMMAND_BACKLOG_LENGTH;
+        backlog->count--;
+    }
+    return true;
+}
+
+bool bc_sendModelCommandData(ModelWorld *mw, const void *command, size_t size) {
+    bc_ModelCommandBacklog *backlog = mw->backlog;
+    // Anything still in the backlog has to go first
+    if (flushBacklog(mw) && bc_pushCommandToBuffer(mw->commands, command, size)) {
+        return true;
+    }
+    if (backlog->count == BC_MODEL_COMMAND_BACKLOG_LENGTH || size > sizeof(bc_ModelCommand)) {
+        if (backlog->dropped++ == 0) {
+            // Only the first time, could be every frame while painting
+            ecs_warn("Model command queue is full, dropping commands. Dropped count is shown in the editor");
+        }
+        return false;
+    }
+    u32 i = (backlog->first + backlog->count) % BC_MODEL_COMMAND_BACKLOG_LENGTH;
+    memcpy(&backlog->commands[i], command, size);
+    backlog->sizes[i] = size;
+    backlog->count++;
+    return true;
+}
+
+// Retry waiting commands every frame, even if nothing new is sent
+void FlushModelCommandBacklog(ecs_iter_t *it) {
+    ModelWorld *mw = ecs_field(it, ModelWorld, 1);
+    if (mw->backlog != NULL) {
+        flushBacklog(mw);
+    }
+}
+
 void SingleStep(ecs_iter_t *it) {
     ModelStepControl *sc = ecs_field(it, ModelStepControl, 1);
 
@@ -137,14 +179,15 @@ void CameraDriftToElevation(ecs_iter_t *it) {
 
     float dT = it->delta_time;
     float targetElevation = 0.0; // drift to 0 if terrain elevation isn't available
+    const bc_SnapshotPlane *sp = NULL;
     if (ecs_field_is_set(it, 2) && ecs_field_is_set(it, 3)) {
         FocusPlane *fp = ecs_field(it, FocusPlane, 2);
-        ModelWorld *mw = ecs_field(it, ModelWorld, 3);
+        const bc_ModelSnapshot *snapshot = ecs_field(it, ModelSnapshot, 3)->snapshot;
+        sp = bc_findSnapshotPlane(snapshot, fp->entity);
+    }
+    if (sp != NULL) {
         const vec3 *scale = ecs_singleton_get(it->world, Scale);
-
-        ecs_entity_t focusPlane = fp->entity;
-        ecs_world_t *modelWorld = mw->world;
-        htw_ChunkMap *cm = ecs_get(modelWorld, focusPlane, Plane)->chunkMap;
+        htw_ChunkMap *cm = sp->plane.chunkMap;
 
         htw_geo_GridCoord originCoord = htw_geo_cartesianToHexCoord(cam->origin.x, cam->origin.y);
         CellData *cd = htw_geo_getCell(cm, originCoord);
@@ -159,6 +202,50 @@ void CameraDriftToElevation(ecs_iter_t *it) {
     cam->origin.z = lerpClamp(cam->origin.z, targetElevation, 2.0 * dT);
 }
 
+// Chunks around the camera on a lazily generated plane are loaded through model commands, so the view never shows empty chunks for long
+#define CAMERA_LOAD_CHUNK_RADIUS 2
+
+void LoadChunksAroundCamera(ecs_iter_t *it) {
+    Camera *cam = ecs_field(it, Camera, 1);
+    FocusPlane *fp = ecs_field(it, FocusPlane, 2);
+    ModelWorld *mw = ecs_field(it, ModelWorld, 3);
+    const bc_ModelSnapshot *snapshot = ecs_field(it, ModelSnapshot, 4)->snapshot;
+
+    // Residency comes from the snapshot, since the model world can't be read here without its mutex
+    const bc_SnapshotPlane *sp = bc_findSnapshotPlane(snapshot, fp->entity);
+    if (sp == NULL || sp->plane.lazyChunks == NULL) {
+        return;
+    }
+    const Plane *plane = &sp->plane;
+    htw_ChunkMap *cm = plane->chunkMap;
+    htw_geo_GridCoord originCoord = htw_geo_cartesianToHexCoord(cam->origin.x, cam->origin.y);
+    u32 centerChunk, centerCell;
+    htw_geo_gridCoordinateToChunkAndCellIndex(cm, originCoord, &centerChunk, &centerCell);
+
+    // Only push while something nearby is missing; the model ignores chunks that are already resident anyway
+    bool allResident = true;
+    for (s32 y = -CAMERA_LOAD_CHUNK_RADIUS; y <= CAMERA_LOAD_CHUNK_RADIUS && allResident; y++) {
+        for (s32 x = -CAMERA_LOAD_CHUNK_RADIUS; x <= CAMERA_LOAD_CHUNK_RADIUS; x++) {
+            u32 c = htw_geo_getChunkIndexAtOffset(cm, centerChunk, (htw_geo_GridCoord){x, y});
+            if (!plane_IsChunkResident(plane, c)) {
+                allResident = false;
+                break;
+            }
+        }
+    }
+    if (allResident) {
+        return;
+    }
+
+    bc_LoadChunksCommand command = {
+        .type = BC_COMMAND_LOAD_CHUNKS,
+        .plane = fp->entity,
+        .center = originCoord,
+        .chunkRadius = CAMERA_LOAD_CHUNK_RADIUS
+    };
+    bc_sendModelCommand(mw, command);
+}
+
 void SelectCell(ecs_iter_t *it) {
     HoveredCell *hovered = ecs_field(it, HoveredCell, 1);
     SelectedCell *selected = ecs_field(it, SelectedCell, 2);
@@ -199,41 +286,49 @@ void CameraToPlayer(ecs_iter_t *it) {
 void SetPlayerDestination(ecs_iter_t *it) {
     PlayerEntity *player = ecs_field(it, PlayerEntity, 1);
     HoveredCell *hoveredCoord = ecs_field(it, HoveredCell, 2);
-    FocusPlane *fp = ecs_field(it, FocusPlane, 3); // TODO: use this to set destination to a different plane
+    FocusPlane *fp = ecs_field(it, FocusPlane, 3);
     ModelWorld *mw = ecs_field(it, ModelWorld, 4);
 
-    ecs_world_t *world = mw->world;
-    if (ecs_is_valid(world, player->entity)) {
-        ecs_set(world, player->entity, Destination, {hoveredCoord->x, hoveredCoord->y});
-        ecs_add_pair(world, player->entity, Action, ActionMove);
-    }
-
-    bc_redraw_model(it->world);
+    // Validity of player is checked by the model when the command is applied
+    bc_SetDestinationCommand command = {
+        .type = BC_COMMAND_SET_DESTINATION,
+        .entity = player->entity,
+        .plane = fp->entity,
+        .destination = *hoveredCoord
+    };
+    bc_sendModelCommand(mw, command);
 }
 
 void PaintPrefabBrush(ecs_iter_t *it) {
     PrefabBrush *pb = ecs_field(it, PrefabBrush, 1);
     HoveredCell *hoveredCoord = ecs_field(it, HoveredCell, 2);
-    htw_geo_GridCoord cellCoord = *(htw_geo_GridCoord*)hoveredCoord;
     FocusPlane *fp = ecs_field(it, FocusPlane, 3);
     ModelWorld *mw = ecs_field(it, ModelWorld, 4);
 
-    ecs_entity_t focusPlane = fp->entity;
-    ecs_world_t *modelWorld = mw->world;
-    Step step = *ecs_singleton_get(modelWorld, Step);
+    bc_SpawnPrefabCommand command = {
+        .type = BC_COMMAND_SPAWN_PREFAB,
+        .plane = fp->entity,
+        .position = *hoveredCoord,
+        .prefab = pb->prefab
+    };
+    bc_sendModelCommand(mw, command);
+}
 
-    ecs_entity_t e;
-    if (pb->prefab != 0) {
-        e = bc_instantiateRandomizer(modelWorld, pb->prefab);
-    } else {
-        e = ecs_new_w_pair(modelWorld, EcsChildOf, focusPlane);
+// Shared by additive and value brushes. Returns false if brushField can't be painted
+static bool getBrushFieldInfo(ecs_world_t *world, ecs_entity_t brushField, ptrdiff_t *offset, ecs_primitive_kind_t *kind) {
+    const EcsMember *member = ecs_get(world, brushField, EcsMember);
+    if (!member) {
+        ecs_err("Target of BrushField has no member metadata: %s", ecs_get_name(world, brushField));
+        return false;
     }
-    ecs_add_pair(modelWorld, e, IsIn, focusPlane);
-    ecs_set(modelWorld, e, Position, {cellCoord.x, cellCoord.y});
-    ecs_set(modelWorld, e, CreationTime, {step});
-    plane_PlaceEntity(modelWorld, focusPlane, e, cellCoord);
-
-    bc_redraw_model(it->world);
+    const EcsPrimitive *prim = ecs_get(world, member->type, EcsPrimitive);
+    if (!prim) {
+        ecs_err("Target of BrushField is not a primitive type and cannot be painted");
+        return false;
+    }
+    *offset = member->offset;
+    *kind = prim->kind;
+    return true;
 }
 
 void PaintAdditiveBrush(ecs_iter_t *it) {
@@ -244,98 +339,44 @@ void PaintAdditiveBrush(ecs_iter_t *it) {
     FocusPlane *fp = ecs_field(it, FocusPlane, 5);
     ModelWorld *mw = ecs_field(it, ModelWorld, 6);
 
-    // Get field offset and type info
-    const EcsMember *member = ecs_get(it->world, brushField, EcsMember);
-    if (!member) {
-        ecs_err("Target of BrushField has no member metadata: %s", ecs_get_name(it->world, brushField));
+    bc_CellFieldCommand command = {
+        .type = BC_COMMAND_CELL_FIELD_ADD,
+        .plane = fp->entity,
+        .center = hoveredCoord,
+        .radius = brushSize->radius,
+    };
+    if (!getBrushFieldInfo(it->world, brushField, &command.fieldOffset, &command.fieldKind)) {
         return;
     }
-    const EcsPrimitive *prim = ecs_get(it->world, member->type, EcsPrimitive);
-    if (!prim) {
-        ecs_err("Target of BrushField is not a primitive type and cannot be painted with AdditiveBrush");
-        return;
-    }
-
-    ptrdiff_t offset = member->offset;
 
     // Get axis data to multiply value by input strength
     void *param = it->param;
     InputVector iv = param ? (*(InputVector*)param) : (InputVector){.x = 1.0};
+    command.value = ab->value * iv.x;
 
-    ecs_entity_t focusPlane = fp->entity;
-    ecs_world_t *modelWorld = mw->world;
-    htw_ChunkMap *cm = ecs_get(modelWorld, focusPlane, Plane)->chunkMap;
-
-    u32 area = htw_geo_getHexArea(brushSize->radius);
-    htw_geo_GridCoord offsetCoord = {0, 0};
-    for (int i = 0; i < area; i++) {
-        CellData *cd = htw_geo_getCell(cm, htw_geo_addGridCoords(hoveredCoord, offsetCoord));
-        void *fieldPtr = ((void*)cd) + offset;
-
-        // get value from cell by offset and primkind
-        s64 value = bc_getMetaComponentMemberInt(fieldPtr, prim->kind);
-        value += ab->value * iv.x;
-        bc_setMetaComponentMemberInt(fieldPtr, prim->kind, value);
-
-        htw_geo_CubeCoord cubeOffset = htw_geo_gridToCubeCoord(offsetCoord);
-        htw_geo_getNextHexSpiralCoord(&cubeOffset);
-        offsetCoord = htw_geo_cubeToGridCoord(cubeOffset);
-    }
-
-    // Mark chunk dirty so it can be rebuilt TODO: will need to to exactly once for each unique chunk modified by a brush
-    // DirtyChunkBuffer *dirty = ecs_singleton_get_mut(world, DirtyChunkBuffer);
-    // u32 chunk = htw_geo_getChunkIndexByGridCoordinates(cm, cellCoord);
-    // dirty->chunks[dirty->count++] = chunk;
-    // ecs_singleton_modified(world, DirtyChunkBuffer);
-
-    bc_redraw_model(it->world);
+    bc_sendModelCommand(mw, command);
 }
 
-// TODO: any clean way to unify the brush systems?
 void PaintValueBrush(ecs_iter_t *it) {
     ValueBrush *vb = ecs_field(it, ValueBrush, 1);
     BrushSize *brushSize = ecs_field(it, BrushSize, 2);
     ecs_entity_t brushField = ECS_PAIR_SECOND(ecs_field_id(it, 3));
-    HoveredCell *hoveredCoord = ecs_field(it, HoveredCell, 4);
-    htw_geo_GridCoord cellCoord = *(htw_geo_GridCoord*)hoveredCoord;
+    HoveredCell hoveredCoord = *ecs_field(it, HoveredCell, 4);
     FocusPlane *fp = ecs_field(it, FocusPlane, 5);
     ModelWorld *mw = ecs_field(it, ModelWorld, 6);
 
-    // Get field offset and type info
-    const EcsMember *member = ecs_get(it->world, brushField, EcsMember);
-    if (!member) {
-        ecs_err("Target of BrushField has no member metadata: %s", ecs_get_name(it->world, brushField));
-        return;
-    }
-    const EcsPrimitive *prim = ecs_get(it->world, member->type, EcsPrimitive);
-    if (!prim) {
-        ecs_err("Target of BrushField is not a primitive type and cannot be painted with ValueBrush");
+    bc_CellFieldCommand command = {
+        .type = BC_COMMAND_CELL_FIELD_SET,
+        .plane = fp->entity,
+        .center = hoveredCoord,
+        .radius = brushSize->radius,
+        .value = vb->value
+    };
+    if (!getBrushFieldInfo(it->world, brushField, &command.fieldOffset, &command.fieldKind)) {
         return;
     }
 
-    ptrdiff_t offset = member->offset;
-
-    ecs_entity_t focusPlane = fp->entity;
-    ecs_world_t *modelWorld = mw->world;
-    htw_ChunkMap *cm = ecs_get(modelWorld, focusPlane, Plane)->chunkMap;
-
-    u32 area = htw_geo_getHexArea(brushSize->radius);
-    htw_geo_GridCoord offsetCoord = {0, 0};
-    for (int i = 0; i < area; i++) {
-        CellData *cd = htw_geo_getCell(cm, htw_geo_addGridCoords(cellCoord, offsetCoord));
-        void *fieldPtr = ((void*)cd) + offset;
-
-        // get value from cell by offset and primkind
-        s64 value = bc_getMetaComponentMemberInt(fieldPtr, prim->kind);
-        value = vb->value;
-        bc_setMetaComponentMemberInt(fieldPtr, prim->kind, value);
-
-        htw_geo_CubeCoord cubeOffset = htw_geo_gridToCubeCoord(offsetCoord);
-        htw_geo_getNextHexSpiralCoord(&cubeOffset);
-        offsetCoord = htw_geo_cubeToGridCoord(cubeOffset);
-    }
-
-    bc_redraw_model(it->world);
+    bc_sendModelCommand(mw, command);
 }
 
 void PaintRiverBrush(ecs_iter_t *it) {
@@ -348,28 +389,21 @@ void PaintRiverBrush(ecs_iter_t *it) {
     void *param = it->param;
     InputVector iv = param ? (*(InputVector*)param) : (InputVector){.x = 1.0};
 
-    ecs_entity_t focusPlane = fp->entity;
-    ecs_world_t *modelWorld = mw->world;
-    htw_ChunkMap *cm = ecs_get(modelWorld, focusPlane, Plane)->chunkMap;
-
     // FIXME: probably broke this by dropping relative from input context
     htw_geo_GridCoord relative = {-iv.x, -iv.y};
     htw_geo_GridCoord prevHoveredCoord = htw_geo_addGridCoords(hoveredCoord, relative);
-    // Only continue if hovered and prevHovered are neighbors
-    // need to account for world wrapping when computing distance
-    s32 distance = htw_geo_getChunkMapHexDistance(cm, hoveredCoord, prevHoveredCoord);
-    if (distance != 1) {
-        return;
-    }
 
-    if (iv.x > 0.0) {
-        bc_makeRiverConnection(cm, prevHoveredCoord, hoveredCoord, rb->value);
-    } else {
-        bc_removeRiverConnection(cm, prevHoveredCoord, hoveredCoord);
-    }
-
-    bc_redraw_model(it->world);
+    // Model ignores the command unless hovered and prevHovered are neighbors
+    bc_RiverCommand command = {
+        .type = iv.x > 0.0 ? BC_COMMAND_RIVER_CONNECT : BC_COMMAND_RIVER_DISCONNECT,
+        .plane = fp->entity,
+        .a = prevHoveredCoord,
+        .b = hoveredCoord,
+        .size = rb->value
+    };
+    bc_sendModelCommand(mw, command);
 }
+
 void SetCameraWrapLimits(ecs_iter_t *it) {
     // singleton
     ecs_entity_t focus = ecs_field(it, FocusPlane, 1)->entity;
@@ -404,6 +438,10 @@ void BcviewSystemsInputImport(ecs_world_t *world) {
     ECS_IMPORT(world, Bcview);
     ECS_IMPORT(world, ComponentsInput);
 
+    ECS_SYSTEM(world, FlushModelCommandBacklog, EcsOnLoad,
+        [inout] ModelWorld($)
+    );
+
     ECS_SYSTEM(world, SingleStep, 0, ModelStepControl($));
     ECS_SYSTEM(world, AutoStep, 0, ModelStepControl($));
     ECS_SYSTEM(world, PauseStep, 0, ModelStepControl($));
@@ -430,7 +468,14 @@ void BcviewSystemsInputImport(ecs_world_t *world) {
     ECS_SYSTEM(world, CameraDriftToElevation, EcsPreUpdate,
         [inout] Camera($),
         ?FocusPlane($),
-        ?ModelWorld($)
+        ?ModelSnapshot($)
+    );
+
+    ECS_SYSTEM(world, LoadChunksAroundCamera, EcsPreUpdate,
+        [in] Camera($),
+        [in] FocusPlane($),
+        [in] ModelWorld($),
+        [in] ModelSnapshot($)
     );
 
     ECS_SYSTEM(world, SelectCell, 0,
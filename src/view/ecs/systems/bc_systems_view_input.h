@@ -2,6 +2,18 @@
 #define BC_SYSTEMS_VIEW_INPUT_H_INCLUDED
 
 #include "flecs.h"
+#include "basaltic_components_view.h"
+
+/**
+ * @brief Push a command onto the model's command ring. While the ring is full, or older commands are still waiting, the command is kept in mw->backlog instead and pushed by a later frame
+ *
+ * @param mw model connection
+ * @param command any model command struct
+ * @param size size of command
+ * @return false if the backlog was full too and the command was dropped
+ */
+bool bc_sendModelCommandData(ModelWorld *mw, const void *command, size_t size);
+#define bc_sendModelCommand(mw, command) bc_sendModelCommandData(mw, &(command), sizeof(command))
 
 void BcviewSystemsInputImport(ecs_world_t *world);
 